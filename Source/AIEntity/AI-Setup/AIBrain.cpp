@@ -0,0 +1,144 @@
+#include "AIBrain.h"
+#include "Async/ParallelFor.h"
+
+static_assert(AISensoryCount <= 64, "Wired sensors are tracked in a 64-bit mask");
+
+void FAIBrain::Wire(TArrayView<const FAIGene> Genome, uint32 MaxNumberNeurons, FAINeuralNet& OutNet)
+{
+	MaxNumberNeurons = FMath::Clamp<uint32>(MaxNumberNeurons, 1, MaxNeurons);
+
+	TArray<FAIGene, TInlineAllocator<512>> Connections;
+	Connections.SetNumUninitialized(Genome.Num());
+
+	// Neurons feeding an action and the other neurons feeding each neuron, one bit per neuron
+	uint64 FeedsAction = 0;
+	uint64 Inputs[MaxNeurons] = {};
+
+	for (int32 i = 0; i < Genome.Num(); i++)
+	{
+		FAIGene Connection = Genome[i];
+
+		if (Connection.SourceType == NEURON) Connection.SourceNum %= MaxNumberNeurons;
+		else Connection.SourceNum %= AISensoryCount;
+
+		if (Connection.SinkType == NEURON) Connection.SinkNum %= MaxNumberNeurons;
+		else Connection.SinkNum %= AIActionsCount;
+
+		if (Connection.SourceType == NEURON)
+		{
+			if (Connection.SinkType == ACTION) FeedsAction |= 1ull << Connection.SourceNum;
+			else if (Connection.SinkNum != Connection.SourceNum)
+				Inputs[Connection.SinkNum] |= 1ull << Connection.SourceNum;
+		}
+
+		Connections[i] = Connection;
+	}
+
+	// Keep only the neurons that reach an action, directly or through other neurons
+	uint64 Kept = FeedsAction;
+
+	for (uint64 Frontier = FeedsAction; Frontier;)
+	{
+		const uint32 Neuron = FMath::CountTrailingZeros64(Frontier);
+		Frontier &= Frontier - 1;
+
+		const uint64 Reached = Inputs[Neuron] & ~Kept;
+		Kept |= Reached;
+		Frontier |= Reached;
+	}
+
+	// Kept neurons are numbered in order, a neuron is driven by anything but itself
+	uint8 Remapped[MaxNeurons];
+	uint64 Driven = 0;
+
+	for (uint64 Rest = Kept; Rest; Rest &= Rest - 1)
+	{
+		const uint32 Neuron = FMath::CountTrailingZeros64(Rest);
+		Remapped[Neuron] = FMath::CountBits(Kept & ((1ull << Neuron) - 1));
+	}
+
+	for (const FAIGene& Connection : Connections)
+	{
+		if (Connection.SinkType == NEURON &&
+			(Connection.SourceType == SENSOR || Connection.SourceNum != Connection.SinkNum))
+			Driven |= 1ull << Connection.SinkNum;
+	}
+
+	OutNet.Connections.Reset();
+	OutNet.Neurons.Reset();
+	OutNet.WiredSensors = 0;
+	OutNet.WiredActions = 0;
+
+	auto Push = [&](FAIGene Connection)
+	{
+		if (Connection.SourceType == NEURON) Connection.SourceNum = Remapped[Connection.SourceNum];
+		else OutNet.WiredSensors |= 1ull << Connection.SourceNum;
+
+		if (Connection.SinkType == NEURON) Connection.SinkNum = Remapped[Connection.SinkNum];
+		else OutNet.WiredActions |= 1ull << Connection.SinkNum;
+
+		OutNet.Connections.Add(Connection);
+	};
+
+	// Connections into neurons first so every neuron output is ready before the actions read it
+	for (const FAIGene& Connection : Connections)
+	{
+		if (Connection.SinkType == NEURON && (Kept & (1ull << Connection.SinkNum))) Push(Connection);
+	}
+
+	for (const FAIGene& Connection : Connections)
+	{
+		if (Connection.SinkType != ACTION) continue;
+
+		if (Connection.SourceType == SENSOR || (Kept & (1ull << Connection.SourceNum))) Push(Connection);
+	}
+
+	for (uint64 Rest = Kept; Rest; Rest &= Rest - 1)
+	{
+		const uint32 Neuron = FMath::CountTrailingZeros64(Rest);
+		OutNet.Neurons.Add({0.5f, (Driven & (1ull << Neuron)) != 0});
+	}
+}
+
+void FAIBrain::WireBatch(TArrayView<const TArrayView<const FAIGene>> Genomes, uint32 MaxNumberNeurons,
+                         TArrayView<FAINeuralNet* const> OutNets)
+{
+	check(Genomes.Num() == OutNets.Num());
+
+	ParallelFor(Genomes.Num(), [&](int32 i)
+	{
+		Wire(Genomes[i], MaxNumberNeurons, *OutNets[i]);
+	});
+}
+
+void FAIBrain::Evaluate(FAINeuralNet& Net, const FAISensorValues& Sensors, FAIActionLevels& OutLevels)
+{
+	TArray<float, TInlineAllocator<64>> NeuralAccumulators;
+	NeuralAccumulators.SetNumZeroed(Net.Neurons.Num());
+
+	OutLevels = FAIActionLevels();
+
+	bool NeuronOutputsComputed = false;
+
+	for (const FAIGene& Connection : Net.Connections)
+	{
+		if (Connection.SinkType == ACTION && !NeuronOutputsComputed)
+		{
+			for (int32 i = 0; i < NeuralAccumulators.Num(); i++)
+			{
+				if (Net.Neurons[i].Driven) Net.Neurons[i].Output = FMath::Tanh(NeuralAccumulators[i]);
+			}
+
+			NeuronOutputsComputed = true;
+		}
+
+		float InputValue;
+
+		if (Connection.SourceType == SENSOR) InputValue = Sensors[(EAISensory)Connection.SourceNum];
+		else InputValue = Net.Neurons[Connection.SourceNum].Output;
+
+		if (Connection.SinkType == ACTION)
+			OutLevels[(EAIActions)Connection.SinkNum] += InputValue * (float)Connection.Weight / 8192.0;
+		else NeuralAccumulators[Connection.SinkNum] += InputValue * (float)(Connection.Weight / 8192.0);
+	}
+}
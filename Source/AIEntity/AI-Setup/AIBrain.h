@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+
+/**
+ * Wiring and evaluation of the neural net grown from a genome, free of any actor so the same brain
+ * can be run live or from a recording
+ */
+struct FAIBrain
+{
+	static constexpr uint8_t ACTION = 1, SENSOR = 1, NEURON = 0;
+
+	/** Neurons are tracked in 64-bit masks while wiring */
+	static constexpr uint32 MaxNeurons = 64;
+
+	/**
+	 * Build the neural net described by a genome. Neurons that can not reach an action, directly or
+	 * through other neurons, are pruned along with their connections.
+	 *
+	 * @param Genome Genes to wire
+	 * @param MaxNumberNeurons Neurons the genes are folded into, at most MaxNeurons
+	 * @param OutNet Resulting neural net
+	 */
+	static void Wire(TArrayView<const FAIGene> Genome, uint32 MaxNumberNeurons, FAINeuralNet& OutNet);
+
+	/**
+	 * Build the neural nets of many genomes across all cores
+	 *
+	 * @param Genomes Genes to wire, one view per brain
+	 * @param MaxNumberNeurons Neurons the genes are folded into, at most MaxNeurons
+	 * @param OutNets Resulting neural nets, one per genome
+	 */
+	static void WireBatch(TArrayView<const TArrayView<const FAIGene>> Genomes, uint32 MaxNumberNeurons,
+	                      TArrayView<FAINeuralNet* const> OutNets);
+
+	/**
+	 * Run one step of a net, neuron outputs are kept in the net for the next step
+	 *
+	 * @param Net Wired neural net
+	 * @param Sensors Sensor values of the step
+	 * @param OutLevels Accumulated level of every action
+	 */
+	static void Evaluate(FAINeuralNet& Net, const FAISensorValues& Sensors, FAIActionLevels& OutLevels);
+};
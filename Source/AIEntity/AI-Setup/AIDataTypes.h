@@ -31,10 +31,15 @@ enum class EAIActions : uint8
 	MOVE_RIGHT,
 	MOVE_BACKWARD,
 	TOUCH_FORWARD,
-	KILL_FORWARD
+	KILL_FORWARD,
+	SPRINT,
+	HEAL
 };
 
-ENUM_RANGE_BY_FIRST_AND_LAST(EAIActions, EAIActions::MOVE_X, EAIActions::KILL_FORWARD)
+ENUM_RANGE_BY_FIRST_AND_LAST(EAIActions, EAIActions::MOVE_X, EAIActions::HEAL)
+
+/** Number of actions, sized for per-action tables */
+static constexpr int32 AIActionsCount = (int32)EAIActions::HEAL + 1;
 
 UENUM()
 enum class EAISensory : uint8
@@ -59,9 +64,22 @@ enum class EAISensory : uint8
 	RANDOM,
 	PHEROMONE_IP,
 	PHEROMONE_FWD,
-	PHEROMONE_LR
+	PHEROMONE_LR,
+	INTEREST_DIST,
+	INTEREST_FWD,
+	WARY_DIST,
+	WARY_FWD,
+	LIKENESS_FWD,
+	HEALTH,
+	STAMINA,
+	SPEED
 };
 
+ENUM_RANGE_BY_FIRST_AND_LAST(EAISensory, EAISensory::LOC_X, EAISensory::SPEED)
+
+/** Number of sensors, sized for per-sensor tables */
+static constexpr int32 AISensoryCount = (int32)EAISensory::SPEED + 1;
+
 UENUM()
 enum EAIDirections
 {
@@ -127,8 +145,27 @@ struct FAIGene
 	uint16_t SinkNum:7;
 
 	int16_t Weight;
+
+	/** Gene as its packed 32-bit word */
+	uint32 ToWord() const
+	{
+		uint32 Word;
+		FMemory::Memcpy(&Word, this, sizeof(Word));
+		return Word;
+	}
+
+	/** Gene from its packed 32-bit word */
+	static FAIGene FromWord(uint32 Word)
+	{
+		FAIGene Gene;
+		FMemory::Memcpy(&Gene, &Word, sizeof(Word));
+		return Gene;
+	}
 };
 
+// Genomes are contiguous packed words, kernels compare and mutate them a word at a time
+static_assert(sizeof(FAIGene) == sizeof(uint32), "FAIGene must pack into a single 32-bit word");
+
 USTRUCT()
 struct FAINeuralNet
 {
@@ -143,6 +180,32 @@ struct FAINeuralNet
 	};
 
 	TArray<Neuron> Neurons;
+
+	/** Sensors read by any connection, one bit per EAISensory */
+	uint64 WiredSensors = 0;
+
+	/** Actions driven by any connection, one bit per EAIActions */
+	uint64 WiredActions = 0;
+};
+
+/** Value of every sensor for one step, only the sensors wired in the brain are sampled */
+struct FAISensorValues
+{
+	float Values[AISensoryCount] = {};
+
+	float& operator[](EAISensory Sensor) { return Values[(uint8)Sensor]; }
+
+	float operator[](EAISensory Sensor) const { return Values[(uint8)Sensor]; }
+};
+
+/** Level of every action the brain produced for one step */
+struct FAIActionLevels
+{
+	float Levels[AIActionsCount] = {};
+
+	float& operator[](EAIActions Action) { return Levels[(uint8)Action]; }
+
+	float operator[](EAIActions Action) const { return Levels[(uint8)Action]; }
 };
 
 USTRUCT()
@@ -155,6 +218,16 @@ struct FAIDIrection
 	FVector Location;
 };
 
+/** Where a genome lives in the population genome arena */
+struct FAIGenomeSpan
+{
+	/** First gene in the arena */
+	int32 Offset = 0;
+
+	/** Number of genes */
+	int32 Num = 0;
+};
+
 USTRUCT()
 struct FAICharacterStats
 {
@@ -168,9 +241,11 @@ struct FAICharacterStats
 	
 	FVector StartLocation;
 
+	FRotator StartRotation;
+
 	unsigned Age;
 
-	TArray<FAIGene> Genome;
+	FAIGenomeSpan Genome;
 
 	FAINeuralNet NeuralNet;
 
@@ -2,6 +2,12 @@
 
 
 #include "AIEntityCharacter.h"
+#include "AIPopulationSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "../AIEntity.h"
+
+DECLARE_CYCLE_STAT(TEXT("Get Sensor"), STAT_AIGetSensor, STATGROUP_AIEntity);
 
 AAIEntityCharacter::AAIEntityCharacter()
 {
@@ -24,13 +30,11 @@ void AAIEntityCharacter::BeginPlay()
 	DeletionRatio = 0.5;
 	Responsiveness = 0.5;
 
-	DisabledGenes.DisabledActions.Add(EAIActions::KILL_FORWARD);
-	DisabledGenes.DisabledActions.Add(EAIActions::TOUCH_FORWARD);
-
 	CharacterStats.Alive = true;
 	CharacterStats.location = GetActorLocation();
+	CharacterStats.StartLocation = GetActorLocation();
+	CharacterStats.StartRotation = GetActorRotation();
 	CharacterStats.Age = 0;
-	CharacterStats.Genome = RandomGenomeGenerator();
 	CharacterStats.Responsiveness = 0.5;
 	CharacterStats.OscillationPeriod = 34;
 	CharacterStats.LongProbesDistance = 16;
@@ -42,22 +46,44 @@ void AAIEntityCharacter::BeginPlay()
 	CharacterStats.KnownSpaceMin = FVector(100.0, 100.0, 0);
 	CharacterStats.KnownSpaceMax = FVector(2980.0, 3400.0, 0);
 
-	WireGenomes();
+	SensorProbes.Init(this, MaxSensorRange);
+	SensorProbes.bLatencyTolerant = bLatencyTolerantSensors;
+
+	Population = GetWorld()->GetSubsystem<UAIPopulationSubsystem>();
+	Population->RegisterEntity(this);
+
+	// Wired along with every other new entity before the first step
+	CharacterStats.Genome = RandomGenomeGenerator();
+}
+
+void AAIEntityCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Population) Population->UnregisterEntity(this);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AAIEntityCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// AdvanceMove(FVector2d(0, 1));
-	for (unsigned CurrStep = 0; CurrStep < StepsPerGeneration; ++CurrStep)
-	{
-		// multithreaded loop: index 0 is reserved, start at 1
-		if (CharacterStats.Alive)
-		{
-			UpdateEntity(CurrStep);
-		}
-	}
+	// Hits traced asynchronously since the last frame
+	if (bLatencyTolerantSensors) SensorProbes.CollectAsync();
+
+	// Brains of entities that just joined
+	Population->WirePendingEntities();
+
+	// One step per frame, the population ends the generation once every step was taken
+	if (CharacterStats.Alive) UpdateEntity(Population->GetCurrentStep());
+
+	// The gait set the walk speed during the parent tick
+	ApplyTraitSpeed();
+
+	// Trace the probes read this frame while the rest of the frame runs
+	if (bLatencyTolerantSensors) SensorProbes.SubmitAsync(SensorEpoch);
+
+	// Drawn once per frame instead of on every trace
+	if (bDrawSensorProbes) SensorProbes.DrawDebug();
 }
 
 bool AAIEntityCharacter::ActionEnabled(EAIActions Action)
@@ -65,7 +91,7 @@ bool AAIEntityCharacter::ActionEnabled(EAIActions Action)
 	return !DisabledGenes.DisabledActions.Contains(Action);
 }
 
-void AAIEntityCharacter::ExecuteAction(TMap<EAIActions, float>& ActionLevels)
+void AAIEntityCharacter::ExecuteAction(const FAIActionLevels& ActionLevels)
 {
 	float Level, ResponsivenessAdjusted = 0;
 
@@ -111,9 +137,11 @@ void AAIEntityCharacter::ExecuteAction(TMap<EAIActions, float>& ActionLevels)
 		Level = (tanh(Level) + 1.0f) / 2.0f;
 		Level *= ResponsivenessAdjusted;
 
+		// Makes the entity a mate candidate at the end of the generation
 		if (Level > threshold)
 		{
-			// Increase pheromones on current location
+			PheromoneSteps++;
+			Behavior.Act(EAIBehaviorAction::Pheromone);
 		}
 	}
 
@@ -127,7 +155,8 @@ void AAIEntityCharacter::ExecuteAction(TMap<EAIActions, float>& ActionLevels)
 
 		if (Level > threshold)
 		{
-			// Action of touch
+			Interact(EAIInteraction::Touch);
+			Behavior.Act(EAIBehaviorAction::Touch);
 		}
 	}
 
@@ -141,7 +170,44 @@ void AAIEntityCharacter::ExecuteAction(TMap<EAIActions, float>& ActionLevels)
 
 		if (Level > threshold)
 		{
-			// Action of kill
+			Interact(EAIInteraction::Kill);
+			Behavior.Act(EAIBehaviorAction::Kill);
+		}
+	}
+
+	/*********************************************************************************************
+	* Trait Type
+	********************************************************************************************* */
+
+	FAITraitStore& Traits = Population->GetTraits();
+
+	// Spend stamina to move faster
+	if (ActionEnabled(EAIActions::SPRINT))
+	{
+		float threshold = 0.5;
+		Level = ActionLevels[EAIActions::SPRINT];
+		Level = (tanh(Level) + 1.0f) / 2.0f;
+		Level *= ResponsivenessAdjusted;
+
+		if (Level > threshold)
+		{
+			Traits.Sprint[PopulationIndex] = FMath::Min(Level, 1.0f);
+			Behavior.Act(EAIBehaviorAction::Sprint);
+		}
+	}
+
+	// Spend stamina to regain health
+	if (ActionEnabled(EAIActions::HEAL))
+	{
+		float threshold = 0.5;
+		Level = ActionLevels[EAIActions::HEAL];
+		Level = (tanh(Level) + 1.0f) / 2.0f;
+		Level *= ResponsivenessAdjusted;
+
+		if (Level > threshold)
+		{
+			Traits.Heal[PopulationIndex] = FMath::Min(Level, 1.0f);
+			Behavior.Act(EAIBehaviorAction::Heal);
 		}
 	}
 	
@@ -171,6 +237,7 @@ void AAIEntityCharacter::ExecuteAction(TMap<EAIActions, float>& ActionLevels)
 		if (Level > threshold)
 		{
             AdvanceJump();
+			Behavior.Act(EAIBehaviorAction::Jump);
 		}
 	}
 
@@ -217,9 +284,9 @@ void AAIEntityCharacter::ExecuteAction(TMap<EAIActions, float>& ActionLevels)
 		Level = ActionLevels[EAIActions::MOVE_RANDOM];
 
 		FRotator RandomRotation = FRotator(
-			FMath::RandRange(-180.0f, 180.0f),
-			FMath::RandRange(-180.0f, 180.0f),
-			FMath::RandRange(-180.0f, 180.0f)
+			Random.FRandRange(-180.0f, 180.0f),
+			Random.FRandRange(-180.0f, 180.0f),
+			Random.FRandRange(-180.0f, 180.0f)
 		);
 		Offset = RandomRotation.Vector();
 
@@ -236,166 +303,84 @@ void AAIEntityCharacter::ExecuteAction(TMap<EAIActions, float>& ActionLevels)
 	MoveX = MoveX > 0 ? 1 : MoveX < 0 ? -1 : 0;
 	MoveY = MoveY > 0 ? 1 : MoveY < 0 ? -1 : 0;
 
+	// Any movement drains stamina
+	Traits.Moved[PopulationIndex] = MoveX != 0 || MoveY != 0 ? 1.0f : 0.0f;
+
+	if (MoveX != 0 || MoveY != 0) Behavior.Act(EAIBehaviorAction::Move);
+
 	AdvanceMove(FVector2D(MoveX, MoveY));
 }
 
-TMap<EAIActions, float> AAIEntityCharacter::SensorToAction(unsigned CurrStep)
+FAIActionLevels AAIEntityCharacter::SensorToAction(unsigned CurrStep)
 {
-	TMap<EAIActions, float> ActionLevels;
-	TArray<float> NeuralAccumulators;
+	FAISensorValues Sensors;
+	FAIActionLevels ActionLevels;
 
-	// Initialize values
-	for (EAIActions action : TEnumRange<EAIActions>()) ActionLevels.Add(action, 0.0f);
-
-	for (unsigned i = 0; i < CharacterStats.NeuralNet.Neurons.Num(); i++) NeuralAccumulators.Add(0);
-
-	bool NeuronOutputsComputed = false;
-
-	for (FAIGene Connection : CharacterStats.NeuralNet.Connections)
+	// Each wired sensor is sampled once, however many connections read it
+	for (uint64 Wired = CharacterStats.NeuralNet.WiredSensors; Wired; Wired &= Wired - 1)
 	{
-		if (Connection.SinkType == ACTION && !NeuronOutputsComputed)
-		{
-			for (unsigned i = 0; i < NeuralAccumulators.Num(); i++)
-			{
-				if (CharacterStats.NeuralNet.Neurons[i].Driven)
-					CharacterStats.NeuralNet.Neurons[i].Output = FMath::Tanh(NeuralAccumulators[i]);
-			}
+		const EAISensory Sensor = (EAISensory)FMath::CountTrailingZeros64(Wired);
+		Sensors[Sensor] = GetSensor(Sensor, CurrStep);
+	}
 
-			NeuronOutputsComputed = true;
-		}
+	FAISensorRecorder* Recorder = Population->GetSensorRecorder();
 
-		float InputValue;
+	// Recorded brains see exactly the quantized vector so replays reproduce the same actions
+	if (Recorder)
+	{
+		Recorder->Quantize(Sensors);
+		Recorder->PrepareStep(GetUniqueID(), GetGenome(), MaxNumberNeurons, CharacterStats.NeuralNet);
+	}
 
-		if (Connection.SourceType == SENSOR) InputValue = GetSensor((EAISensory)Connection.SourceNum, CurrStep, EDrawDebugTrace::ForOneFrame);
-		else InputValue = CharacterStats.NeuralNet.Neurons[Connection.SourceNum].Output;
+	FAIBrain::Evaluate(CharacterStats.NeuralNet, Sensors, ActionLevels);
 
-		if (Connection.SinkType == ACTION)
-			ActionLevels[(EAIActions)Connection.SinkNum] += InputValue * (float)
-				Connection.Weight / 8192.0;
-		else NeuralAccumulators[Connection.SinkNum] += InputValue * (float)(Connection.Weight / 8192.0);
-	}
+	if (Recorder) Recorder->RecordStep(GetUniqueID(), SensorEpoch, Sensors, ActionLevels);
 
 	return ActionLevels;
 }
 
-FHitResult AAIEntityCharacter::DistanceObjectHit(EAIDirections Direction, ECollisionChannel Channel,
-                                                 EDrawDebugTrace::Type Debug, FColor TraceColor, FColor TraceHitColor)
+float AAIEntityCharacter::BarrierDistance(EAIProbeRay Ray)
 {
-	FVector StartLocation = GetActorLocation();
-
-	switch (Direction)
-	{
-	case EAIDirections::NORTH:
-		{
-			// Measures the distance to nearest boundary in the south-north axis,
-			// max distance is half the grid height; scaled to sensor range 0.0..1.0.
-
-			FHitResult HitNorth;
-
-			FVector EndLocationNorth = StartLocation + FVector(0, MaxSensorRange, 0); // North (Y+)
-
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				StartLocation,
-				EndLocationNorth,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>(),
-				Debug,
-				HitNorth,
-				true,
-				FLinearColor::FromSRGBColor(TraceColor),
-				FLinearColor::FromSRGBColor(TraceHitColor)
-			);
-
-			return HitNorth;
-		}
-
-	case EAIDirections::SOUTH:
-		{
-			// Measures the distance to nearest boundary in the south-north axis,
-			// max distance is half the grid height; scaled to sensor range 0.0..1.0.
+	const FHitResult* Barrier = SensorProbes.Probe(Ray, SensorEpoch).FirstBarrier();
 
-			FHitResult HitSouth;
-
-			FVector EndLocationSouth = StartLocation + FVector(0, -MaxSensorRange, 0); // South (Y-)
-
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				StartLocation,
-				EndLocationSouth,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>(),
-				Debug,
-				HitSouth,
-				true,
-				FLinearColor::FromSRGBColor(TraceColor),
-				FLinearColor::FromSRGBColor(TraceHitColor)
-			);
-
-			return HitSouth;
-		}
-
-	case EAIDirections::EAST:
-		{
-			// Measures the distance to nearest boundary in the east-west axis,
-			// max distance is half the grid width; scaled to sensor range 0.0..1.0.
+	return Barrier ? Barrier->Distance : MaxSensorRange;
+}
 
-			FHitResult HitEast;
+float AAIEntityCharacter::LikenessSensor(EAIEntityState State, bool bDirection)
+{
+	FVector2D Target;
 
-			FVector EndLocationEast = GetActorLocation() + FVector(MaxSensorRange, 0, 0); // East (X+)
+	if (!Population->FindNearestLikeness(State, GetActorLocation(), MaxSensorRange, Target))
+		return bDirection ? 0.5f : 1.0f;
 
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				StartLocation,
-				EndLocationEast,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>(),
-				Debug,
-				HitEast,
-				true,
-				FLinearColor::FromSRGBColor(TraceColor),
-				FLinearColor::FromSRGBColor(TraceHitColor)
-			);
+	const FVector2D Offset = Target - FVector2D(GetActorLocation());
 
-			return HitEast;
-		}
+	// Alignment of the forward axis with the target, behind 0.0, sideways 0.5, ahead 1.0
+	if (bDirection)
+		return (FVector2D::DotProduct(FVector2D(GetActorRotation().Vector()).GetSafeNormal(), Offset.GetSafeNormal()) +
+			1.0f) / 2.0f;
 
-	case EAIDirections::WEST:
-		{
-			// Measures the distance to nearest boundary in the east-west axis,
-			// max distance is half the grid width; scaled to sensor range 0.0..1.0.
+	return Offset.Size() / MaxSensorRange;
+}
 
-			FHitResult HitWest;
+float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIGetSensor);
 
-			FVector EndLocationWest = GetActorLocation() + FVector(-MaxSensorRange, 0, 0); // West (X-)
+	const FVector Location = GetActorLocation();
+	const float Yaw = GetActorRotation().Yaw;
+	float SensorValue;
 
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				StartLocation,
-				EndLocationWest,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>(),
-				Debug,
-				HitWest,
-				true,
-				FLinearColor::FromSRGBColor(TraceColor),
-				FLinearColor::FromSRGBColor(TraceHitColor)
-			);
+	// Slowly changing sensors are reused until the entity moved or turned enough
+	if (SensorCache.Lookup(Sensor, Location, Yaw, SensorEpoch, SensorValue)) return SensorValue;
 
-			return HitWest;
-		}
+	SensorValue = SampleSensor(Sensor, CurrStep);
+	SensorCache.Store(Sensor, Location, Yaw, SensorEpoch, SensorValue);
 
-	default:
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, "Invalid Direction");
-		break;
-	}
+	return SensorValue;
 }
 
-float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawDebugTrace::Type Debug)
+float AAIEntityCharacter::SampleSensor(EAISensory Sensor, unsigned CurrStep)
 {
 	float SensorValue = 0.0f;
 
@@ -412,24 +397,17 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 			// Finds closest boundary, compares that to the max possible dist
 			// to a boundary from the center, and converts that linearly to the
 			// sensor range 0.0..1.0
-			FHitResult HitEast, HitWest, HitNorth, HitSouth;
-
-			HitEast = DistanceObjectHit(EAIDirections::EAST, ECC_WorldStatic, Debug);
-			HitWest = DistanceObjectHit(EAIDirections::WEST, ECC_WorldStatic, Debug);
 
 			// Take the closest boundary distance
 			float ClosestDistanceX = FMath::Min(
-				HitEast.bBlockingHit ? HitEast.Distance : MaxSensorRange,
-				HitWest.bBlockingHit ? HitWest.Distance : MaxSensorRange
+				BarrierDistance(EAIProbeRay::East),
+				BarrierDistance(EAIProbeRay::West)
 			);
 
-			HitNorth = DistanceObjectHit(EAIDirections::NORTH, ECC_WorldStatic, Debug);
-			HitSouth = DistanceObjectHit(EAIDirections::SOUTH, ECC_WorldStatic, Debug);
-
 			// Take the closest boundary distance
 			float ClosestDistanceY = FMath::Min(
-				HitNorth.bBlockingHit ? HitNorth.Distance : MaxSensorRange,
-				HitSouth.bBlockingHit ? HitSouth.Distance : MaxSensorRange
+				BarrierDistance(EAIProbeRay::North),
+				BarrierDistance(EAIProbeRay::South)
 			);
 
 			// Normalize to 0.0 - 1.0
@@ -441,15 +419,10 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 			// Measures the distance to nearest boundary in the east-west axis,
 			// max distance is half the grid width; scaled to sensor range 0.0..1.0.
 
-			FHitResult HitEast, HitWest;
-
-			HitEast = DistanceObjectHit(EAIDirections::EAST, ECC_WorldStatic, Debug);
-			HitWest = DistanceObjectHit(EAIDirections::WEST, ECC_WorldStatic, Debug);
-
 			// Take the closest boundary distance
 			float ClosestDistanceX = FMath::Min(
-				HitEast.bBlockingHit ? HitEast.Distance : MaxSensorRange,
-				HitWest.bBlockingHit ? HitWest.Distance : MaxSensorRange
+				BarrierDistance(EAIProbeRay::East),
+				BarrierDistance(EAIProbeRay::West)
 			);
 
 			// Normalize to 0.0 - 1.0
@@ -461,15 +434,10 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 			// Measures the distance to nearest boundary in the south-north axis,
 			// max distance is half the grid height; scaled to sensor range 0.0..1.0.
 
-			FHitResult HitNorth, HitSouth;
-
-			HitNorth = DistanceObjectHit(EAIDirections::NORTH, ECC_WorldStatic, Debug);
-			HitSouth = DistanceObjectHit(EAIDirections::SOUTH, ECC_WorldStatic, Debug);
-
 			// Take the closest boundary distance
 			float ClosestDistanceY = FMath::Min(
-				HitNorth.bBlockingHit ? HitNorth.Distance : MaxSensorRange,
-				HitSouth.bBlockingHit ? HitSouth.Distance : MaxSensorRange
+				BarrierDistance(EAIProbeRay::North),
+				BarrierDistance(EAIProbeRay::South)
 			);
 
 			// Normalize to 0.0 - 1.0
@@ -525,27 +493,22 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 			// Measures the distance to the nearest other individual in the
 			// forward direction. If non found, returns the maximum sensor value.
 			// Maps the result to the sensor range 0.0..1.0.
-			FHitResult Hit;
+			float DistancePopulation = MaxSensorRange;
 
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				GetActorLocation(),
-				GetActorLocation() + (GetActorRotation().Vector() * MaxSensorRange),
-				UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_Visibility),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				Hit,
-				true
-			);
+			for (const FHitResult& Hit : SensorProbes.Probe(EAIProbeRay::Forward, SensorEpoch).Hits)
+			{
+				if (Cast<AAIEntityCharacter>(Hit.GetActor()))
+				{
+					DistancePopulation = Hit.Distance;
+					break;
+				}
 
-			float distancePopulation;
-			if (!Hit.GetActor() || Hit.GetActor()->IsA(AAIEntityCharacter::StaticClass()))
-				distancePopulation = MaxSensorRange;
-			else distancePopulation = Hit.Distance;
+				// Sight is blocked by a barrier before anybody was found
+				if (Hit.GetComponent() && Hit.GetComponent()->GetCollisionObjectType() == ECC_WorldStatic) break;
+			}
 
 			// Normalize to 0.0 - 1.0
-			SensorValue = distancePopulation / MaxSensorRange;
+			SensorValue = DistancePopulation / MaxSensorRange;
 			break;
 		}
 	case EAISensory::LONGPROBE_BAR_FWD:
@@ -553,24 +516,9 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 			// Measures the distance to the nearest barrier in the forward
 			// direction. If non found, returns the maximum sensor value.
 			// Maps the result to the sensor range 0.0..1.0.
-			FHitResult Hit;
-
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				GetActorLocation(),
-				GetActorLocation() + (GetActorRotation().Vector() * MaxSensorRange),
-				UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				Hit,
-				true
-			);
-
-			float DistanceBarrier = Hit.bBlockingHit ? Hit.Distance : MaxSensorRange;
 
 			// Normalize to 0.0 - 1.0
-			SensorValue = DistanceBarrier / MaxSensorRange;
+			SensorValue = BarrierDistance(EAIProbeRay::Forward) / MaxSensorRange;
 			break;
 		}
 	case EAISensory::POPULATION_IP:
@@ -579,182 +527,80 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 			// 0..100% to sensor range
 			unsigned CountPopulation = 0;
 
-			TArray<FHitResult> Hit;
-
-			UKismetSystemLibrary::SphereTraceMulti(
-				this,
-				GetActorLocation(),
-				GetActorLocation(),
-				500,
-				UEngineTypes::ConvertToTraceType(ECC_Pawn),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				Hit,
-				true
-			);
-
-			for (FHitResult HitResult : Hit)
+			for (const FHitResult& Hit : SensorProbes.Probe(EAIProbeRay::Neighborhood, SensorEpoch).Hits)
 			{
-				if (Cast<AAIEntityCharacter>(HitResult.GetActor())) // Change this to your AI class
-				{
-					CountPopulation++;
-				}
+				if (Cast<AAIEntityCharacter>(Hit.GetActor())) CountPopulation++;
 			}
-			SensorValue = CountPopulation / PopulationRef.Num();
+
+			SensorValue = (float)CountPopulation / PopulationRef.Num();
 			break;
 		}
 	case EAISensory::POPULATION_FWD:
 		{
 			// Sense population density along axis of last movement direction, mapped
 			// to sensor range 0.0..1.0
-			unsigned CountPopulation = 0;
-
-			TArray<FHitResult> Hit;
+			int32 CountBehind, CountAhead;
 
-			UKismetSystemLibrary::LineTraceMulti(
-				this,
+			// Entities behind the first barrier are out of sight
+			Population->GetGrid().CountAlongLine(
 				GetActorLocation(),
-				GetActorLocation() + (GetActorRotation().Vector() * MaxSensorRange),
-				UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				Hit,
-				true
+				FAIProbeBundle::RayDirection(EAIProbeRay::Forward, GetActorRotation()),
+				0,
+				BarrierDistance(EAIProbeRay::Forward),
+				GetCapsuleComponent()->GetScaledCapsuleRadius(),
+				FAISpatialGrid::KindBit(EAIGridKind::Entity),
+				this,
+				CountBehind,
+				CountAhead
 			);
 
-			for (FHitResult HitResult : Hit)
-			{
-				if (Cast<AAIEntityCharacter>(HitResult.GetActor())) // Change this to your AI class
-				{
-					CountPopulation++;
-				}
-			}
-			SensorValue = CountPopulation / PopulationRef.Num();
+			SensorValue = (float)CountAhead / PopulationRef.Num();
 			break;
 		}
 	case EAISensory::POPULATION_LR:
 		{
-			// Sense population density along an axis 90 degrees from last movement direction
-			unsigned CountPopulation = 0;
+			// Sense population density along an axis 90 degrees from last movement direction,
+			// left and right halves of the axis are counted in one pass up to the barrier on each side
+			int32 CountLeft, CountRight;
 
-			TArray<FHitResult> HitL, HitR;
-
-			UKismetSystemLibrary::LineTraceMulti(
-				this,
+			Population->GetGrid().CountAlongLine(
 				GetActorLocation(),
-				GetActorLocation() + FRotator(0, -90, 0).RotateVector(GetActorRotation().Vector() * MaxSensorRange),
-				UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				HitL,
-				true
-			);
-
-			UKismetSystemLibrary::LineTraceMulti(
+				FAIProbeBundle::RayDirection(EAIProbeRay::Right, GetActorRotation()),
+				-BarrierDistance(EAIProbeRay::Left),
+				BarrierDistance(EAIProbeRay::Right),
+				GetCapsuleComponent()->GetScaledCapsuleRadius(),
+				FAISpatialGrid::KindBit(EAIGridKind::Entity),
 				this,
-				GetActorLocation(),
-				GetActorLocation() + FRotator(0, 90, 0).RotateVector(GetActorRotation().Vector() * MaxSensorRange),
-				UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				HitR,
-				true
+				CountLeft,
+				CountRight
 			);
 
-			for (FHitResult HitResult : HitL)
-			{
-				if (Cast<AAIEntityCharacter>(HitResult.GetActor())) // Change this to your AI class
-				{
-					CountPopulation++;
-				}
-			}
-
-			for (FHitResult HitResult : HitR)
-			{
-				if (Cast<AAIEntityCharacter>(HitResult.GetActor())) // Change this to your AI class
-				{
-					CountPopulation++;
-				}
-			}
-
-			SensorValue = CountPopulation / PopulationRef.Num();
+			SensorValue = (float)(CountLeft + CountRight) / PopulationRef.Num();
 			break;
 		}
 	case EAISensory::BARRIER_FWD:
 		{
 			// Sense the nearest barrier along axis of last movement direction, mapped
-			// to sensor range 0.0..1.               0
-
-			FHitResult Hit;
-
-			FVector EndLocation = GetActorLocation() + (MaxSensorRange * GetActorRotation().Vector());
-
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				GetActorLocation(),
-				EndLocation,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				Hit,
-				true
-			);
-
-			float DistanceBarrier = Hit.bBlockingHit ? Hit.Distance : MaxSensorRange;
-
-			SensorValue = DistanceBarrier / MaxSensorRange;
+			// to sensor range 0.0..1.0
+			SensorValue = BarrierDistance(EAIProbeRay::Forward) / MaxSensorRange;
 			break;
 		}
 	case EAISensory::BARRIER_LR:
 		{
 			// Sense the nearest barrier along axis perpendicular to last movement direction, mapped
 			// to sensor range 0.0..1.0
-			FHitResult HitR, HitL;
-
-			FVector EndLocationR = GetActorLocation() + FRotator(0, 90, 0).RotateVector(
-				MaxSensorRange * GetActorRotation().Vector());
-			FVector EndLocationL = GetActorLocation() + FRotator(0, -90, 0).RotateVector(
-				MaxSensorRange * GetActorRotation().Vector());
-
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				GetActorLocation(),
-				EndLocationR,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				HitR,
-				true
+			float DistanceBarrier = FMath::Min(
+				BarrierDistance(EAIProbeRay::Left),
+				BarrierDistance(EAIProbeRay::Right)
 			);
 
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				GetActorLocation(),
-				EndLocationL,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				HitL,
-				true
-			);
-
-			float DistanceBarrier = HitL.bBlockingHit ? HitL.Distance : MaxSensorRange;
-			DistanceBarrier = HitR.bBlockingHit ? FMath::Min(HitR.Distance, DistanceBarrier) : DistanceBarrier;
-
 			SensorValue = DistanceBarrier / MaxSensorRange;
 			break;
 		}
 	case EAISensory::RANDOM:
 		{
 			// Returns a random sensor value in the range 0.0..1.0.
-			SensorValue = FMath::RandRange(0, 100) / 100;
+			SensorValue = Random.GetFraction();
 			break;
 		}
 	case EAISensory::PHEROMONE_IP:
@@ -781,50 +627,84 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 			// Return minimum sensor value if nobody is alive in the forward adjacent location,
 			// else returns a similarity match in the sensor range 0.0..1.0
 
-			FHitResult Hit;
-			unsigned SimilarCount = 0, TotalComparison = CharacterStats.Genome.Num();
-
-			FVector EndLocation = GetActorLocation() + (MaxSensorRange * GetActorRotation().Vector()); // East (X+)
+			const FAIProbeResult& Forward = SensorProbes.Probe(EAIProbeRay::Forward, SensorEpoch);
 
-			UKismetSystemLibrary::LineTraceSingle(
-				this,
-				GetActorLocation(),
-				EndLocation,
-				UEngineTypes::ConvertToTraceType(ECC_WorldStatic),
-				false,
-				TArray<AActor*>({this}),
-				Debug,
-				Hit,
-				true
-			);
+			AAIEntityCharacter* Other = Forward.Hits.Num() ? Cast<AAIEntityCharacter>(Forward.Hits[0].GetActor()) : nullptr;
 
-			if (Cast<AAIEntityCharacter>(Hit.GetActor()) && Cast<AAIEntityCharacter>(Hit.GetActor())->CharacterStats.
-				Alive)
-			{
-				for (int i = 0; i < TotalComparison; i++)
-				{
-					if (
-						CharacterStats.Genome[i].Weight == Cast<AAIEntityCharacter>(Hit.GetActor())->
-						                                   CharacterStats.Genome[i].Weight &&
-						CharacterStats.Genome[i].SinkNum == Cast<AAIEntityCharacter>(Hit.GetActor())->
-						                                    CharacterStats.Genome[i].SinkNum &&
-						CharacterStats.Genome[i].SinkType == Cast<AAIEntityCharacter>(Hit.GetActor())->
-						                                     CharacterStats.Genome[i].SinkType &&
-						CharacterStats.Genome[i].SourceNum == Cast<AAIEntityCharacter>(Hit.GetActor())->
-						                                      CharacterStats.Genome[i].SourceNum &&
-						CharacterStats.Genome[i].SourceType == Cast<AAIEntityCharacter>(Hit.GetActor())->
-						                                       CharacterStats.Genome[i].SourceType
-					)
-						SimilarCount++;
-				}
-			}
-			else
+			if (!Other || !Other->CharacterStats.Alive)
 			{
 				SensorValue = 0;
 				break;
 			}
 
-			SensorValue = SimilarCount / TotalComparison;
+			// Same pair this step, reuse the comparison
+			if (GeneticSimCache.Other != Other || GeneticSimCache.Epoch != SensorEpoch)
+			{
+				GeneticSimCache.Other = Other;
+				GeneticSimCache.Epoch = SensorEpoch;
+				GeneticSimCache.Value = FAIGenomeKernels::Similarity(GetGenome(), Other->GetGenome());
+			}
+
+			SensorValue = GeneticSimCache.Value;
+			break;
+		}
+	case EAISensory::INTEREST_DIST:
+		{
+			// Distance to the nearest interested location or object, maximum sensor
+			// value if none is in range; mapped to sensor range 0.0..1.0
+			SensorValue = LikenessSensor(EAIEntityState::Interested, false);
+			break;
+		}
+	case EAISensory::INTEREST_FWD:
+		{
+			// Direction of the nearest interested location or object relative to the
+			// forward axis; mapped to sensor range 0.0..1.0
+			SensorValue = LikenessSensor(EAIEntityState::Interested, true);
+			break;
+		}
+	case EAISensory::WARY_DIST:
+		{
+			// Distance to the nearest wary location or object, maximum sensor
+			// value if none is in range; mapped to sensor range 0.0..1.0
+			SensorValue = LikenessSensor(EAIEntityState::Wary, false);
+			break;
+		}
+	case EAISensory::WARY_FWD:
+		{
+			// Direction of the nearest wary location or object relative to the
+			// forward axis; mapped to sensor range 0.0..1.0
+			SensorValue = LikenessSensor(EAIEntityState::Wary, true);
+			break;
+		}
+	case EAISensory::LIKENESS_FWD:
+		{
+			// Likeness of the first thing in the forward direction, wary 0.0,
+			// neutral or unknown 0.5, interested 1.0
+			const FAIProbeResult& Forward = SensorProbes.Probe(EAIProbeRay::Forward, SensorEpoch);
+			EAIEntityState State = EAIEntityState::Neutral;
+
+			if (Forward.Hits.Num()) Population->ClassifyLikeness(Forward.Hits[0].GetActor(), State);
+
+			SensorValue = State == EAIEntityState::Interested ? 1.0f : State == EAIEntityState::Wary ? 0.0f : 0.5f;
+			break;
+		}
+	case EAISensory::HEALTH:
+		{
+			// Health left, 0.0 dead to 1.0 full
+			SensorValue = Population->GetTraits().Health[PopulationIndex];
+			break;
+		}
+	case EAISensory::STAMINA:
+		{
+			// Stamina left, 0.0 exhausted to 1.0 rested
+			SensorValue = Population->GetTraits().Stamina[PopulationIndex];
+			break;
+		}
+	case EAISensory::SPEED:
+		{
+			// Speed scale of the last step relative to a full sprint
+			const FAITraitStore& Traits = Population->GetTraits();
+			SensorValue = Traits.Speed[PopulationIndex] / Traits.MaxSpeed();
 			break;
 		}
 	default:
@@ -840,173 +720,251 @@ float AAIEntityCharacter::GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawD
 void AAIEntityCharacter::UpdateEntity(unsigned CurrStep)
 {
 	CharacterStats.Age++;
-	TMap<EAIActions, float> ActionLevels = SensorToAction(CurrStep);
+	SensorEpoch++; // Probe rays from the previous step are stale
+	ExploredBox += FVector2D(GetActorLocation());
+	Behavior.Step(FVector2D(GetActorLocation()), FVector2D(CharacterStats.KnownSpaceMin),
+	              FVector2D(CharacterStats.KnownSpaceMax));
+	FAIActionLevels ActionLevels = SensorToAction(CurrStep);
 	ExecuteAction(ActionLevels);
 }
 
-TArray<FAIGene> AAIEntityCharacter::RandomGenomeGenerator()
+void AAIEntityCharacter::Interact(EAIInteraction Kind)
 {
-	TArray<FAIGene> Genome;
+	const FAISpatialGridEntry* Target = Population->GetGrid().FindNearestAhead(
+		GetActorLocation(),
+		GetActorRotation().Vector(),
+		FMath::Cos(FMath::DegreesToRadians(InteractionHalfAngle)),
+		FAISpatialGrid::KindBit(EAIGridKind::Entity),
+		InteractionReach,
+		this
+	);
 
-	unsigned length = FMath::RandRange(GenomeInitialLengthMin, GenomeInitialLengthMax);
+	if (!Target) return;
 
-	for (unsigned i = 0; i < length; i++)
-	{
-		Genome.Push(FAIGene(
-			FMath::RandRange(0, 1), // 1-bit unsigned
-			FMath::RandRange(0, 32767), // 16-bit unsigned
-			FMath::RandRange(0, 1), // 1-bit unsigned
-			FMath::RandRange(0, 32767), // 16-bit unsigned
-			FMath::RandRange(-32768, 32768) // 16-bit signed
-		));
-	}
+	// Applied once every entity took the step
+	AAIEntityCharacter* Other = static_cast<AAIEntityCharacter*>(Target->Actor);
+	Population->EmitInteraction({this, Other, PopulationIndex, Other->GetPopulationIndex(), Kind});
+}
 
-	return Genome;
+void AAIEntityCharacter::Kill()
+{
+	CharacterStats.Alive = false;
+	ApplyAlive();
 }
 
-void AAIEntityCharacter::WireGenomes()
+void AAIEntityCharacter::Touched()
 {
-	TArray<FAIGene> ConnectionList;
-	TMap<uint16_t, FNeuron> NeuronMap;
+	TouchCount++;
+}
 
-	// Setup list of genes on array
-	ConnectionList.Empty();
-	for (auto const& Gene : CharacterStats.Genome)
-	{
-		ConnectionList.Push(Gene);
-		auto& Connection = ConnectionList.Last();
+void AAIEntityCharacter::GetBehavior(const FVector& Location, FAIBehavior& OutBehavior) const
+{
+	Behavior.Describe(FVector2D(Location), FVector2D(CharacterStats.KnownSpaceMin),
+	                  FVector2D(CharacterStats.KnownSpaceMax), OutBehavior);
+}
 
-		if (Connection.SourceType == NEURON) Connection.SourceNum %= MaxNumberNeurons;
-		else Connection.SourceNum %= StaticEnum<EAISensory>()->NumEnums() - 1;
+float AAIEntityCharacter::GetExploredFraction() const
+{
+	if (!ExploredBox.bIsValid) return 0.0f;
 
-		if (Connection.SinkType == NEURON) Connection.SinkNum %= MaxNumberNeurons;
-		else Connection.SinkNum %= StaticEnum<EAIActions>()->NumEnums() - 1;
-	}
+	const FVector2D KnownMin(CharacterStats.KnownSpaceMin), KnownMax(CharacterStats.KnownSpaceMax);
+	const FVector2D Min = FVector2D::Max(ExploredBox.Min, KnownMin);
+	const FVector2D Max = FVector2D::Min(ExploredBox.Max, KnownMax);
 
-	NeuronMap.Empty();
-	for (auto const& Connection : ConnectionList)
-	{
-		if (Connection.SinkType == NEURON)
-		{
-			auto curr = NeuronMap.Find(Connection.SinkNum);
+	if (Min.X > Max.X || Min.Y > Max.Y) return 0.0f;
 
-			if (curr == nullptr)
-			{
-				NeuronMap.Add(Connection.SinkNum, {});
-				curr = NeuronMap.Find(Connection.SinkNum);
-				curr->NumOutputs = 0;
-				curr->NumSelfInputs = 0;
-				curr->NumInputsFromSensorsOrOtherNeurons = 0;
-			}
+	return (Max - Min).Size() / FMath::Max((KnownMax - KnownMin).Size(), UE_SMALL_NUMBER);
+}
 
-			if (Connection.SourceType == NEURON && (Connection.SourceNum == Connection.SinkNum))
-				(curr->NumSelfInputs)++;
-			else
-				(curr->NumInputsFromSensorsOrOtherNeurons)++;
-		}
+void AAIEntityCharacter::ApplyAlive()
+{
+	SetActorHiddenInGame(!CharacterStats.Alive);
+	SetActorEnableCollision(CharacterStats.Alive);
+}
 
-		if (Connection.SourceType == NEURON)
-		{
-			auto curr = NeuronMap.Find(Connection.SourceNum);
+void AAIEntityCharacter::ApplyTraitSpeed()
+{
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
 
-			if (curr == nullptr)
-			{
-				NeuronMap.Add(Connection.SourceNum, {});
-				curr = NeuronMap.Find(Connection.SourceNum);
-				curr->NumOutputs = 0;
-				curr->NumSelfInputs = 0;
-				curr->NumInputsFromSensorsOrOtherNeurons = 0;
-			}
-			(curr->NumOutputs)++;
-		}
-	}
-	// Remove extra neurons
-	bool Cleaned = false;
-	while (!Cleaned)
-	{
-		Cleaned = true;
+	// The gait only resets the walk speed while grounded, otherwise the last scaled speed is still set
+	if (Movement->MaxWalkSpeed != TraitWalkSpeed) GaitWalkSpeed = Movement->MaxWalkSpeed;
 
-		// Collect keys to remove first to avoid modifying the map while iterating
-		TArray<uint16_t> NeuronsToRemove;
+	TraitWalkSpeed = GaitWalkSpeed * Population->GetTraits().Speed[PopulationIndex];
+	Movement->MaxWalkSpeed = TraitWalkSpeed;
+}
 
-		for (const auto& Elem : NeuronMap)
-		{
-			uint16_t NeuronKey = Elem.Key;
-			const FNeuron& Neuron = Elem.Value;
+FAIGenomeSpan AAIEntityCharacter::RandomGenomeGenerator()
+{
+	FAIGenomeArena& Arena = Population->GetGenomeArena();
 
-			if (Neuron.NumOutputs == Neuron.NumSelfInputs)
-			{
-				// Could be 0
-				Cleaned = false;
-				NeuronsToRemove.Add(NeuronKey);
-			}
-		}
+	const FAIGenomeSpan Genome = Arena.Allocate(Random.RandRange(GenomeInitialLengthMin, GenomeInitialLengthMax));
+	FAIGenomeKernels::RandomGenes(Arena.GetMutable(Genome), Genome.Num, Random);
 
-		// Remove collected neurons
-		for (uint16_t NeuronKey : NeuronsToRemove)
-		{
-			CutNeuron(NeuronKey, ConnectionList, NeuronMap);
-			NeuronMap.Remove(NeuronKey);
-		}
-	}
+	return Genome;
+}
 
-	CharacterStats.NeuralNet.Connections.Empty();
+FAIGenerationParams AAIEntityCharacter::GetGenerationParams() const
+{
+	FAIGenerationParams Params;
+	Params.StepsPerGeneration = StepsPerGeneration;
+	Params.GenomeInitialLengthMin = GenomeInitialLengthMin;
+	Params.GenomeInitialLengthMax = GenomeInitialLengthMax;
+	Params.GenomeMaxLength = GenomeMaxLength;
+	Params.MaxNumberNeurons = MaxNumberNeurons;
+	Params.PointMutationRate = PointMutationRate;
+	Params.GeneInsertionDeletionRate = GeneInsertionDeletionRate;
+	Params.DeletionRatio = DeletionRatio;
+
+	return Params;
+}
 
-	// Setup neurons and sensors connection
-	for (auto const& Connection : ConnectionList)
-	{
-		if (Connection.SourceType == NEURON)
-		{
-			CharacterStats.NeuralNet.Connections.Push(Connection);
-			auto& NewNeuron = CharacterStats.NeuralNet.Connections.Last();
+TArrayView<const FAIGene> AAIEntityCharacter::GetGenome() const
+{
+	return Population->GetGenomeArena().Get(CharacterStats.Genome);
+}
 
-			// Setup destination
-			if (NeuronMap.Find(NewNeuron.SinkNum))
-				NewNeuron.SinkNum = NeuronMap.Find(NewNeuron.SinkNum)->RemappedNumber;
-			// Setup source
-			if (NewNeuron.SourceType == NEURON)
-				NewNeuron.SourceNum = NeuronMap.Find(NewNeuron.SourceNum)->RemappedNumber;
-		}
-	}
+void AAIEntityCharacter::StartGeneration(bool bSurvived, int32 RandomSeed)
+{
+	CharacterStats.SuccessRate = (unsigned)bSurvived;
+	CharacterStats.Alive = true;
+	CharacterStats.Age = 0;
+	CharacterStats.location = CharacterStats.StartLocation;
+	CharacterStats.Responsiveness = 0.5;
+	CharacterStats.OscillationPeriod = 34;
+	CharacterStats.LongProbesDistance = 16;
 
-	// Connect sensors and neurons to actions
-	for (auto const& Connection : ConnectionList)
-	{
-		if (Connection.SinkType == ACTION)
-		{
-			CharacterStats.NeuralNet.Connections.Push(Connection);
-			auto& NewNeuron = CharacterStats.NeuralNet.Connections.Last();
-			// Setup source
-			if (NewNeuron.SourceType == NEURON)
-				NewNeuron.SourceNum = NeuronMap.Find(NewNeuron.SourceNum)->RemappedNumber;
-		}
-	}
+	TouchCount = 0;
+	PheromoneSteps = 0;
+	ExploredBox = FBox2D(ForceInit);
+	Behavior.Reset();
 
-	// Create neural node list
-	CharacterStats.NeuralNet.Neurons.Empty();
-	for (auto CurrentNeuron : NeuronMap)
-	{
-		CharacterStats.NeuralNet.Neurons.Push({});
-		CharacterStats.NeuralNet.Neurons.Last().Output = 0.5;
-		CharacterStats.NeuralNet.Neurons.Last().Driven = (CurrentNeuron.Value.NumInputsFromSensorsOrOtherNeurons != 0);
-	}
+	Population->GetTraits().Reset(PopulationIndex);
+
+	Random.Initialize(RandomSeed);
+
+	ApplyAlive();
+
+	// Every generation starts from the same pose, however it was reached, so a replayed journal lines up
+	const FRotator StartRotation = CharacterStats.StartRotation;
+	SetActorLocationAndRotation(CharacterStats.StartLocation, StartRotation, false, nullptr,
+	                            ETeleportType::TeleportPhysics);
+
+	if (AController* EntityController = GetController()) EntityController->SetControlRotation(StartRotation);
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetDefaultMovementMode();
+
+	FActionMotion Motion;
+	Motion.PreviousVelocity = FVector::ZeroVector;
+	Motion.PreviousAimYaw = StartRotation.Yaw;
+	Motion.InAirRotation = Motion.LastVelocityRotation = StartRotation;
+	Motion.LastMovementInputRotation = Motion.TargetRotation = StartRotation;
+	LoadMotion(Motion);
+
+	CharacterStats.LastMovementDirection = FAIDIrection(
+		FRotator(GetActorRotation()),
+		FVector(GetActorLocation())
+	);
+
+	SensorProbes.Invalidate();
+	SensorCache.Invalidate();
+	GeneticSimCache = FAIGenomeSimilarityCache();
+
+	if (FAISensorRecorder* Recorder = Population->GetSensorRecorder()) Recorder->ForgetEntity(GetUniqueID());
 }
 
-void AAIEntityCharacter::CutNeuron(uint16_t NeuronNum, TArray<FAIGene>& Connections, TMap<uint16_t, FNeuron> NeuronMap)
+void AAIEntityCharacter::SaveState(FAISnapshotEntity& Out, TArray<float>& OutNeurons) const
 {
-	for (int32 i = 0; i < Connections.Num();)
+	Out.Location = GetActorLocation();
+	Out.Rotation = GetActorRotation();
+	Out.ControlRotation = GetControlRotation();
+	Out.Velocity = GetCharacterMovement()->Velocity;
+	Out.MovementMode = GetCharacterMovement()->MovementMode;
+
+	SaveMotion(Out.Motion);
+
+	Out.StartLocation = CharacterStats.StartLocation;
+	Out.StartRotation = CharacterStats.StartRotation;
+	Out.KnownSpaceMin = CharacterStats.KnownSpaceMin;
+	Out.KnownSpaceMax = CharacterStats.KnownSpaceMax;
+	Out.LastMovementLocation = CharacterStats.LastMovementDirection.Location;
+	Out.LastMovementRotation = CharacterStats.LastMovementDirection.Rotation;
+
+	Out.NeuronOffset = OutNeurons.Num();
+	Out.NeuronNum = CharacterStats.NeuralNet.Neurons.Num();
+
+	for (const FAINeuralNet::Neuron& Neuron : CharacterStats.NeuralNet.Neurons) OutNeurons.Add(Neuron.Output);
+
+	Out.Alive = CharacterStats.Alive;
+	Out.Age = CharacterStats.Age;
+	Out.OscillationPeriod = CharacterStats.OscillationPeriod;
+	Out.LongProbesDistance = CharacterStats.LongProbesDistance;
+	Out.SuccessRate = CharacterStats.SuccessRate;
+	Out.SensorEpoch = SensorEpoch;
+	Out.Responsiveness = CharacterStats.Responsiveness;
+	Out.Health = Population->GetTraits().Health[PopulationIndex];
+	Out.Stamina = Population->GetTraits().Stamina[PopulationIndex];
+	Out.Speed = Population->GetTraits().Speed[PopulationIndex];
+	Out.TouchCount = TouchCount;
+	Out.PheromoneSteps = PheromoneSteps;
+	Out.ExploredMin = ExploredBox.Min;
+	Out.ExploredMax = ExploredBox.Max;
+	Out.bExplored = ExploredBox.bIsValid;
+	Out.Behavior = Behavior;
+	Out.SensorCache = SensorCache;
+	SensorProbes.Save(Out.Probes);
+	Out.RandomSeed = Random.GetCurrentSeed();
+}
+
+void AAIEntityCharacter::LoadState(const FAISnapshotEntity& State, TArrayView<const float> Neurons)
+{
+	CharacterStats.location = State.Location;
+	CharacterStats.StartLocation = State.StartLocation;
+	CharacterStats.StartRotation = State.StartRotation;
+	CharacterStats.KnownSpaceMin = State.KnownSpaceMin;
+	CharacterStats.KnownSpaceMax = State.KnownSpaceMax;
+	CharacterStats.LastMovementDirection = FAIDIrection(State.LastMovementRotation, State.LastMovementLocation);
+
+	// Outputs only carry over if the brain was wired the same way
+	if (Neurons.Num() == CharacterStats.NeuralNet.Neurons.Num())
 	{
-		if (Connections[i].SinkType == NEURON && Connections[i].SinkNum == NeuronNum)
-		{
-			// Remove the connection. If the connection source is from another
-			// neuron, also decrement the other neuron's numOutputs:
-			if (Connections[i].SourceType == NEURON)
-			{
-				if (NeuronMap.Find(Connections[i].SourceNum))
-					(NeuronMap.Find(Connections[i].SourceNum)->NumOutputs)--;
-			}
-			Connections.RemoveAt(i); // Removes the element at index i
-		}
-		else i++;
+		for (int32 i = 0; i < Neurons.Num(); i++) CharacterStats.NeuralNet.Neurons[i].Output = Neurons[i];
 	}
-}
\ No newline at end of file
+
+	CharacterStats.Alive = State.Alive != 0;
+	CharacterStats.Age = State.Age;
+	CharacterStats.OscillationPeriod = State.OscillationPeriod;
+	CharacterStats.LongProbesDistance = State.LongProbesDistance;
+	CharacterStats.SuccessRate = State.SuccessRate;
+	CharacterStats.Responsiveness = State.Responsiveness;
+	SensorEpoch = State.SensorEpoch;
+	Random.Initialize(State.RandomSeed);
+	TouchCount = State.TouchCount;
+	PheromoneSteps = State.PheromoneSteps;
+	ExploredBox = FBox2D(State.ExploredMin, State.ExploredMax);
+	ExploredBox.bIsValid = State.bExplored != 0;
+	Behavior = State.Behavior;
+
+	FAITraitStore& Traits = Population->GetTraits();
+	Traits.Reset(PopulationIndex);
+	Traits.Health[PopulationIndex] = State.Health;
+	Traits.Stamina[PopulationIndex] = State.Stamina;
+	Traits.Speed[PopulationIndex] = State.Speed;
+
+	ApplyAlive();
+	SetActorLocationAndRotation(State.Location, State.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+	if (AController* EntityController = GetController()) EntityController->SetControlRotation(State.ControlRotation);
+
+	GetCharacterMovement()->SetMovementMode((EMovementMode)State.MovementMode);
+	GetCharacterMovement()->Velocity = State.Velocity;
+
+	LoadMotion(State.Motion);
+
+	// The entity is in place, so held hits can be traced again and cached values are reused as they would have been
+	SensorProbes.Load(State.Probes);
+	SensorCache = State.SensorCache;
+	GeneticSimCache = FAIGenomeSimilarityCache();
+
+	if (FAISensorRecorder* Recorder = Population->GetSensorRecorder()) Recorder->ForgetEntity(GetUniqueID());
+}
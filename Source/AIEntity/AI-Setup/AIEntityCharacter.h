@@ -4,10 +4,20 @@
 
 #include "CoreMinimal.h"
 #include "AIDataTypes.h"
+#include "AISensorProbes.h"
+#include "AIGenomeKernels.h"
+#include "AISensorCache.h"
+#include "AIBrain.h"
+#include "AIGeneration.h"
+#include "AISnapshot.h"
+#include "AIInteraction.h"
+#include "AINovelty.h"
 #include "../Movement-Setup/ActionSetup.h"
 #include "Kismet/GameplayStatics.h"
 #include "AIEntityCharacter.generated.h"
 
+class UAIPopulationSubsystem;
+
 /**
  * 
  */
@@ -20,6 +30,8 @@ protected:
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	FDisabledGenes DisabledGenes;
 
 	FAICharacterStats CharacterStats;
@@ -28,6 +40,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FAILikenessComponents FAILikenessComponents;
 
+	/** Sensors read probe hits traced asynchronously on the previous frame instead of blocking traces */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bLatencyTolerantSensors = false;
+
+	/** Draw the sensor probes and their hits every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bDrawSensorProbes = false;
+
+	/** Distance an entity in front can be touched or killed from */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float InteractionReach = 150.0f;
+
+	/** Half angle of the cone in front an entity is reached in, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float InteractionHalfAngle = 30.0f;
+
 	float SuccessRate;
 
 	EAISensory SensoryType;
@@ -35,30 +63,139 @@ public:
 
 	AAIEntityCharacter();
 
+	bool IsAlive() const { return CharacterStats.Alive; }
+
+	unsigned GetAge() const { return CharacterStats.Age; }
+
+	FAIGenerationParams GetGenerationParams() const;
+
+	/** Genes of the entity, hold them inside a read scope of the genome arena */
+	TArrayView<const FAIGene> GetGenome() const;
+
+	const FAIGenomeSpan& GetGenomeSpan() const { return CharacterStats.Genome; }
+
+	/** Point to a new genome in the genome arena, the brain has to be rewired afterwards */
+	void SetGenome(const FAIGenomeSpan& Genome) { CharacterStats.Genome = Genome; }
+
+	FAINeuralNet& GetNeuralNet() { return CharacterStats.NeuralNet; }
+
+	const FAINeuralNet& GetNeuralNet() const { return CharacterStats.NeuralNet; }
+
+	bool HasSurvived() const { return CharacterStats.SuccessRate != 0; }
+
+	/** Die at the end of the step, only called by the population once the health trait runs out */
+	void Kill();
+
+	/** Feel a touch at the end of the step, only called by the interaction commit */
+	void Touched();
+
+	/** Emitted pheromone above the threshold at any step of this generation */
+	bool IsEmittingPheromone() const { return PheromoneSteps > 0; }
+
+	int32 GetTouchCount() const { return TouchCount; }
+
+	/** What the entity did this generation, safe off the game thread when the location was read beforehand */
+	void GetBehavior(const FVector& Location, FAIBehavior& OutBehavior) const;
+
+	/** Diagonal of the known space covered by the locations of this generation, in the range 0.0..1.0 */
+	float GetExploredFraction() const;
+
+	/**
+	 * Reset the entity to the start of a generation
+	 *
+	 * @param bSurvived If the entity survived the previous generation
+	 * @param RandomSeed Seed the random stream restarts from
+	 */
+	void StartGeneration(bool bSurvived, int32 RandomSeed);
+
+	/**
+	 * Store the state of the entity in a snapshot
+	 *
+	 * @param Out Snapshot entry, the genome span is left to the caller
+	 * @param OutNeurons Neuron outputs are appended here
+	 */
+	void SaveState(FAISnapshotEntity& Out, TArray<float>& OutNeurons) const;
+
+	/**
+	 * Restore the state of the entity from a snapshot, the brain must already be wired from the
+	 * restored genome
+	 *
+	 * @param State Snapshot entry
+	 * @param Neurons Neuron outputs of the entity
+	 */
+	void LoadState(const FAISnapshotEntity& State, TArrayView<const float> Neurons);
+
+	const FAIProbeBundle& GetSensorProbes() const { return SensorProbes; }
+
+	FRandomStream& GetRandom() { return Random; }
+
+	/** Slot of the entity in the population registry and the trait store */
+	int32 GetPopulationIndex() const { return PopulationIndex; }
+
+	void SetPopulationIndex(int32 Index) { PopulationIndex = Index; }
+
 private:
-	void ExecuteAction(TMap<EAIActions, float> &ActionLevels);
+	friend class FAIPopulationSensorBarrierTest;
+
+	void ExecuteAction(const FAIActionLevels& ActionLevels);
 
-	TMap<EAIActions, float> SensorToAction(unsigned CurrStep);
+	FAIActionLevels SensorToAction(unsigned CurrStep);
 
 	bool ActionEnabled(EAIActions Action);
 
-	FHitResult DistanceObjectHit(EAIDirections Direction, ECollisionChannel Channel, EDrawDebugTrace::Type Debug,
-	                             FColor TraceColor = FColor::Red, FColor TraceHitColor = FColor::Green);
+	float BarrierDistance(EAIProbeRay Ray);
 
-	float GetSensor(EAISensory Sensor, unsigned CurrStep, EDrawDebugTrace::Type Debug = EDrawDebugTrace::None);
+	float LikenessSensor(EAIEntityState State, bool bDirection);
+
+	float GetSensor(EAISensory Sensor, unsigned CurrStep);
+
+	float SampleSensor(EAISensory Sensor, unsigned CurrStep);
 
 	void UpdateEntity(unsigned CurrStep);
 
-    TArray<FAIGene> RandomGenomeGenerator();
+	/** Emit an interaction with the nearest entity in front, if any is in reach */
+	void Interact(EAIInteraction Kind);
 
-	void WireGenomes();
+	void ApplyAlive();
 
-	void CutNeuron(uint16_t NeuronNum,TArray<FAIGene>& Connections, TMap<uint16_t, FNeuron> NeuronMap);
+	FAIGenomeSpan RandomGenomeGenerator();
 
 	static constexpr uint8_t ACTION = 1, SENSOR = 1, NEURON = 0;
 	float MaxSensorRange = 3000.0f;
 	TArray<AActor*> PopulationRef;
 
+	UPROPERTY()
+	TObjectPtr<UAIPopulationSubsystem> Population;
+
+	FAIProbeBundle SensorProbes;
+	uint32 SensorEpoch = 0;
+
+	FAIGenomeSimilarityCache GeneticSimCache;
+
+	FAISensorCache SensorCache;
+
+	FRandomStream Random;
+
+	int32 TouchCount = 0;
+
+	/** Bounds of every location this generation stepped on */
+	FBox2D ExploredBox = FBox2D(ForceInit);
+
+	/** Counts the behavior of this generation is described from */
+	FAIBehaviorAccumulator Behavior;
+
+	/** Steps of this generation pheromone was emitted in */
+	int32 PheromoneSteps = 0;
+
+	int32 PopulationIndex = INDEX_NONE;
+
+	/** Walk speed of the gait before the speed trait, and the scaled speed handed to the mover */
+	float GaitWalkSpeed = 0.0f;
+	float TraitWalkSpeed = 0.0f;
+
+	/** Scale the walk speed of the current gait by the speed trait */
+	void ApplyTraitSpeed();
+
 	int GenomeInitialLengthMin;
 	int GenomeInitialLengthMax;
 	unsigned GenomeMaxLength;
@@ -0,0 +1,39 @@
+#include "AIFileFormat.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+bool FAIFileView::Open(const FString& Path)
+{
+	Close();
+
+	MappedFile = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path);
+
+	if (MappedFile) MappedRegion = MappedFile->MapRegion(0, MappedFile->GetFileSize());
+
+	if (MappedRegion)
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Loaded, *Path, FILEREAD_Silent))
+	{
+		Data = Loaded.GetData();
+		Size = Loaded.Num();
+	}
+	else return false;
+
+	return true;
+}
+
+void FAIFileView::Close()
+{
+	delete MappedRegion;
+	delete MappedFile;
+
+	MappedRegion = nullptr;
+	MappedFile = nullptr;
+	Loaded.Empty();
+	Data = nullptr;
+	Size = 0;
+}
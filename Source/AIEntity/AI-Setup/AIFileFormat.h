@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/** Start of every file the simulation writes, the header of each format derives from it */
+struct FAIFileHeader
+{
+	uint32 Magic = 0;
+	uint32 Version = 0;
+
+	/** If the header is of the same format and version as the one this build writes */
+	bool Matches(const FAIFileHeader& Expected) const
+	{
+		return Magic == Expected.Magic && Version == Expected.Version;
+	}
+};
+
+/** Whole file in memory for reading in place, mapped where the platform allows it */
+class FAIFileView
+{
+public:
+	~FAIFileView() { Close(); }
+
+	/**
+	 * Map or load a file
+	 *
+	 * @param Path File to read
+	 * @return If the file could be read
+	 */
+	bool Open(const FString& Path);
+
+	void Close();
+
+	const uint8* GetData() const { return Data; }
+
+	int64 GetSize() const { return Size; }
+
+	/** Header of the file if it starts with a header of this build's format and version, nullptr otherwise */
+	template <typename HeaderType>
+	const HeaderType* GetHeader() const
+	{
+		if (Size < (int64)sizeof(HeaderType)) return nullptr;
+
+		const HeaderType* Header = (const HeaderType*)Data;
+		return Header->Matches(HeaderType()) ? Header : nullptr;
+	}
+
+private:
+	IMappedFileHandle* MappedFile = nullptr;
+	IMappedFileRegion* MappedRegion = nullptr;
+
+	/** Used when the platform can not map files */
+	TArray<uint8> Loaded;
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+};
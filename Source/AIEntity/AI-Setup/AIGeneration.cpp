@@ -0,0 +1,593 @@
+#include "AIGeneration.h"
+#include "AIEntityCharacter.h"
+#include "AIGenomeKernels.h"
+#include "../AIEntity.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Generation Turnover"), STAT_AIGenerationTurnover, STATGROUP_AIEntity);
+DECLARE_CYCLE_STAT(TEXT("Generation Replace"), STAT_AIGenerationReplace, STATGROUP_AIEntity);
+
+void FAIGenerationEngine::Turnover(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+                                   const FAIGenerationParams& Params, TArrayView<const bool> Survives,
+                                   TArrayView<const float> Objectives)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIGenerationTurnover);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 Num = Entities.Num();
+
+	check(Survives.Num() == Num);
+
+	Survived.Reset();
+	Survived.Append(Survives);
+
+	const bool bMultiObjective = Params.bMultiObjective && Objectives.Num() == Num * AIObjectiveNum;
+
+	Parents.Reset();
+
+	int32 SurvivorNum = 0;
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		SurvivorNum += Survived[i] ? 1 : 0;
+
+		if (bMultiObjective ? Entities[i]->IsAlive() : Survived[i]) Parents.Add(i);
+	}
+
+	if (bMultiObjective && !Parents.IsEmpty()) Pareto.Rank(Objectives, AIObjectiveNum, Parents);
+
+	const int32 Pairs = Params.bMating ? PairMates(Entities, Params) : 0;
+
+	// Parent, crossover and length of every child
+	ParentOf.SetNumUninitialized(Num);
+	Children.SetNumUninitialized(Num);
+	Crossovers.SetNumUninitialized(Num);
+
+	ParallelFor(Num, [&](int32 i)
+	{
+		FRandomStream& Random = Entities[i]->GetRandom();
+		FAICrossover& Crossover = Crossovers[i];
+
+		Crossover = FAICrossover();
+
+		if (Parents.IsEmpty())
+		{
+			// Nobody made it, start over from random genomes
+			ParentOf[i] = INDEX_NONE;
+			Children[i].Num = Random.RandRange(Params.GenomeInitialLengthMin, Params.GenomeInitialLengthMax);
+			return;
+		}
+
+		int32 Parent = Random.RandHelper(Parents.Num());
+
+		// Binary tournament, the better front wins and then the less crowded entity
+		if (bMultiObjective)
+		{
+			const int32 Rival = Random.RandHelper(Parents.Num());
+			if (Pareto.IsBetter(Rival, Parent)) Parent = Rival;
+		}
+
+		ParentOf[i] = Parents[Parent];
+		Children[i].Num = Entities[ParentOf[i]]->GetGenomeSpan().Num;
+
+		if (Pairs == 0 || MateOf[ParentOf[i]] == INDEX_NONE) return;
+
+		// Cuts fall inside both genomes so the child keeps the length of its parent
+		const int32 Shared = FMath::Min(Children[i].Num, Entities[MateOf[ParentOf[i]]]->GetGenomeSpan().Num);
+
+		Crossover.Mate = MateOf[ParentOf[i]];
+		Crossover.Start = Random.RandRange(0, Shared);
+		Crossover.End = Random.FRand() < 0.5f ? Shared : Random.RandRange(Crossover.Start, Shared);
+	});
+
+	FAIGene* Back = LayoutChildren(Arena, Params);
+
+	// Reproduction, children are signed while their genes are still in cache
+	ChildEdits.SetNum(Num);
+	Signatures.SetNumUninitialized(Num);
+
+	{
+		// Parents are read from the current generation until the swap
+		const FAIGenomeArena::FReadScope ReadScope(Arena);
+
+		ParallelFor(Num, [&](int32 i)
+		{
+			FRandomStream& Random = Entities[i]->GetRandom();
+			FAIGenomeSpan& Child = Children[i];
+			FAIGene* Genes = Back + Child.Offset;
+
+			ChildEdits[i].Reset();
+
+			if (ParentOf[i] == INDEX_NONE) FAIGenomeKernels::RandomGenes(Genes, Child.Num, Random);
+			else
+			{
+				const FAICrossover& Crossover = Crossovers[i];
+
+				Recombine(Genes, Arena.Get(Entities[ParentOf[i]]->GetGenomeSpan()),
+				          Crossover.Mate == INDEX_NONE ? TArrayView<const FAIGene>()
+				                                       : Arena.Get(Entities[Crossover.Mate]->GetGenomeSpan()),
+				          Crossover);
+
+				FAIGenomeKernels::Mutate(Genes, Child.Num, Params.PointMutationRate, Params.GeneInsertionDeletionRate,
+				                         Params.DeletionRatio, Params.GenomeMaxLength, Random,
+				                         bRecordDelta ? &ChildEdits[i] : nullptr);
+			}
+
+			FAIGenomeKernels::Sign(TArrayView<const FAIGene>(Genes, Child.Num), Signatures[i]);
+		});
+	}
+
+	if (bRecordDelta)
+	{
+		Delta.Generation = Generation + 1;
+		Delta.Survived = Survived;
+		Delta.ParentOf = ParentOf;
+		Delta.Crossovers = Crossovers;
+		Delta.EditStart.SetNumUninitialized(Num + 1);
+		Delta.Edits.Reset();
+		Delta.RandomNum.Reset();
+		Delta.RandomGenes.Reset();
+
+		for (int32 i = 0; i < Num; i++)
+		{
+			Delta.EditStart[i] = Delta.Edits.Num();
+			Delta.Edits.Append(ChildEdits[i]);
+
+			if (ParentOf[i] != INDEX_NONE) continue;
+
+			Delta.RandomNum.Add(Children[i].Num);
+			Delta.RandomGenes.Append(Back + Children[i].Offset, Children[i].Num);
+		}
+
+		Delta.EditStart[Num] = Delta.Edits.Num();
+	}
+
+	Arena.Swap();
+	Generation++;
+
+	Finish(Entities, Arena, Params);
+
+	UE_LOG(LogAIEntity, Log,
+	       TEXT("Generation %u: %d of %d survived, %d mating pairs, %d fronts, turnover took %.3f ms"), Generation,
+	       SurvivorNum, Num, Pairs, bMultiObjective ? Pareto.GetFrontNum() : 0,
+	       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+int32 FAIGenerationEngine::Replace(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+                                   const FAIGenerationParams& Params, TArrayView<const bool> Survives,
+                                   TArrayView<const int32> Slots)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIGenerationReplace);
+
+	const int32 Num = Entities.Num();
+
+	check(Survives.Num() == Num);
+
+	// Entities joined since the last turnover have no signature yet
+	if (Signatures.Num() != Num) Sign(Entities, Arena);
+
+	Replaced.Init(false, Num);
+	for (const int32 Slot : Slots) Replaced[Slot] = true;
+
+	// Fit entities first, anyone still alive when none is
+	Parents.Reset();
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (!Replaced[i] && Survives[i]) Parents.Add(i);
+	}
+
+	if (Parents.IsEmpty())
+	{
+		for (int32 i = 0; i < Num; i++)
+		{
+			if (!Replaced[i] && Entities[i]->IsAlive()) Parents.Add(i);
+		}
+	}
+
+	// Children go at the end of the current generation, placed before any gene is written so the
+	// buffer does not move under the parallel pass
+	SlotParents.SetNumUninitialized(Slots.Num());
+	SlotChildren.SetNumUninitialized(Slots.Num());
+
+	for (int32 k = 0; k < Slots.Num(); k++)
+	{
+		FRandomStream& Random = Entities[Slots[k]]->GetRandom();
+		int32 ChildNum;
+
+		if (Parents.IsEmpty())
+		{
+			SlotParents[k] = INDEX_NONE;
+			ChildNum = Random.RandRange(Params.GenomeInitialLengthMin, Params.GenomeInitialLengthMax);
+		}
+		else
+		{
+			SlotParents[k] = Parents[Random.RandHelper(Parents.Num())];
+			ChildNum = Entities[SlotParents[k]]->GetGenomeSpan().Num;
+		}
+
+		SlotChildren[k] = Arena.Allocate(ChildNum + (ChildNum < Params.GenomeMaxLength ? 1 : 0));
+		SlotChildren[k].Num = ChildNum;
+	}
+
+	{
+		const FAIGenomeArena::FReadScope ReadScope(Arena);
+
+		ParallelFor(Slots.Num(), [&](int32 k)
+		{
+			FRandomStream& Random = Entities[Slots[k]]->GetRandom();
+			FAIGenomeSpan& Child = SlotChildren[k];
+			FAIGene* Genes = Arena.GetMutable(Child);
+
+			if (SlotParents[k] == INDEX_NONE) FAIGenomeKernels::RandomGenes(Genes, Child.Num, Random);
+			else
+			{
+				Recombine(Genes, Arena.Get(Entities[SlotParents[k]]->GetGenomeSpan()), TArrayView<const FAIGene>(),
+				          FAICrossover());
+
+				FAIGenomeKernels::Mutate(Genes, Child.Num, Params.PointMutationRate, Params.GeneInsertionDeletionRate,
+				                         Params.DeletionRatio, Params.GenomeMaxLength, Random);
+			}
+
+			FAIGenomeKernels::Sign(Arena.Get(Child), Signatures[Slots[k]]);
+		});
+
+		Genomes.Reset();
+		Nets.Reset();
+
+		for (int32 k = 0; k < Slots.Num(); k++)
+		{
+			Genomes.Add(Arena.Get(SlotChildren[k]));
+			Nets.Add(&Entities[Slots[k]]->GetNeuralNet());
+		}
+
+		FAIBrain::WireBatch(Genomes, Params.MaxNumberNeurons, Nets);
+	}
+
+	for (int32 k = 0; k < Slots.Num(); k++)
+	{
+		Entities[Slots[k]]->SetGenome(SlotChildren[k]);
+		Entities[Slots[k]]->StartGeneration(false, HashCombine(HashCombine(Seed, Generation), Births + k));
+	}
+
+	Births += Slots.Num();
+
+	int32 Generations = 0;
+
+	for (; Num > 0 && Births >= Num; Births -= Num) Generations++;
+
+	Generation += Generations;
+
+	// Replaced genomes stay behind as gaps until the live ones are moved out
+	int64 LiveNum = 0;
+	for (int32 i = 0; i < Num; i++) LiveNum += Entities[i]->GetGenomeSpan().Num;
+
+	if (Arena.Num() > 2 * LiveNum + Num) Compact(Entities, Arena, Params);
+
+	return Generations;
+}
+
+void FAIGenerationEngine::Compact(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+                                  const FAIGenerationParams& Params)
+{
+	const int32 Num = Entities.Num();
+
+	Children.SetNumUninitialized(Num);
+	for (int32 i = 0; i < Num; i++) Children[i].Num = Entities[i]->GetGenomeSpan().Num;
+
+	FAIGene* Back = LayoutChildren(Arena, Params);
+
+	{
+		const FAIGenomeArena::FReadScope ReadScope(Arena);
+
+		ParallelFor(Num, [&](int32 i)
+		{
+			FMemory::Memcpy(Back + Children[i].Offset, Arena.Get(Entities[i]->GetGenomeSpan()).GetData(),
+			                Children[i].Num * sizeof(FAIGene));
+		});
+	}
+
+	Arena.Swap();
+
+	for (int32 i = 0; i < Num; i++) Entities[i]->SetGenome(Children[i]);
+}
+
+int32 FAIGenerationEngine::PairMates(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities,
+                                     const FAIGenerationParams& Params)
+{
+	const int32 Num = Entities.Num();
+
+	MateOf.Init(INDEX_NONE, Num);
+	Emitters.Reset();
+	EmitterLocations.Reset();
+	EmitterOf.Reset();
+	MateGrid.Reset();
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (!Survived[i] || !Entities[i]->IsEmittingPheromone()) continue;
+
+		// Actors are only read here on the game thread, the rounds use the copied locations
+		EmitterOf.Add(Entities[i].Get(), i);
+		Emitters.Add(i);
+		EmitterLocations.Add(Entities[i]->GetActorLocation());
+		MateGrid.Add(Entities[i].Get(), EmitterLocations.Last(), EAIGridKind::Entity);
+	}
+
+	MateGrid.Build();
+	Candidates.SetNumUninitialized(Num);
+
+	int32 Pairs = 0;
+
+	for (int32 Round = 0; Round < Params.MatingRounds; Round++)
+	{
+		// Every unpaired emitter proposes to its nearest unpaired emitter, reading pairs of earlier rounds only
+		ParallelFor(Emitters.Num(), [&](int32 e)
+		{
+			const int32 i = Emitters[e];
+			Candidates[i] = INDEX_NONE;
+
+			if (MateOf[i] != INDEX_NONE) return;
+
+			const FAISpatialGridEntry* Nearest = MateGrid.FindNearestMatching(
+				EmitterLocations[e],
+				Params.MateDistance,
+				[&](const FAISpatialGridEntry& Entry)
+				{
+					return Entry.Actor != Entities[i].Get() && MateOf[EmitterOf[Entry.Actor]] == INDEX_NONE;
+				}
+			);
+
+			if (Nearest) Candidates[i] = EmitterOf[Nearest->Actor];
+		});
+
+		// Mutual proposals pair up, each emitter only writes its own slot
+		std::atomic<int32> RoundPairs = 0;
+
+		ParallelFor(Emitters.Num(), [&](int32 e)
+		{
+			const int32 i = Emitters[e];
+			const int32 Candidate = Candidates[i];
+
+			if (Candidate == INDEX_NONE || Candidates[Candidate] != i) return;
+
+			MateOf[i] = Candidate;
+			if (i < Candidate) ++RoundPairs;
+		});
+
+		Pairs += RoundPairs.load();
+
+		if (RoundPairs.load() == 0) break;
+	}
+
+	return Pairs;
+}
+
+void FAIGenerationEngine::Recombine(FAIGene* Genes, TArrayView<const FAIGene> Parent, TArrayView<const FAIGene> Mate,
+                                    const FAICrossover& Crossover)
+{
+	FMemory::Memcpy(Genes, Parent.GetData(), Parent.Num() * sizeof(FAIGene));
+
+	if (Crossover.Mate == INDEX_NONE) return;
+
+	FMemory::Memcpy(Genes + Crossover.Start, Mate.GetData() + Crossover.Start,
+	                (Crossover.End - Crossover.Start) * sizeof(FAIGene));
+}
+
+bool FAIGenerationEngine::CanReplay(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities,
+                                    const FAIGenerationParams& Params, const FAIGenerationDelta& Recorded)
+{
+	const int32 Num = Entities.Num();
+
+	if (Recorded.Survived.Num() != Num || Recorded.ParentOf.Num() != Num || Recorded.Crossovers.Num() != Num ||
+		Recorded.EditStart.Num() != Num + 1 || Recorded.EditStart[Num] > Recorded.Edits.Num())
+		return false;
+
+	int32 RandomIndex = 0, RandomGeneNum = 0;
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		const int32 Parent = Recorded.ParentOf[i];
+
+		if (Parent == INDEX_NONE)
+		{
+			if (!Recorded.RandomNum.IsValidIndex(RandomIndex)) return false;
+
+			const int32 RandomNum = Recorded.RandomNum[RandomIndex++];
+			if (RandomNum < 0 || RandomNum > Params.GenomeMaxLength) return false;
+
+			RandomGeneNum += RandomNum;
+			continue;
+		}
+
+		if (Parent < 0 || Parent >= Num) return false;
+
+		// The child starts as a copy of its parent in a slot with room for one insertion below the max length
+		const int32 ParentNum = Entities[Parent]->GetGenomeSpan().Num;
+		const int32 Room = ParentNum + (ParentNum < Params.GenomeMaxLength ? 1 : 0);
+
+		const FAICrossover& Crossover = Recorded.Crossovers[i];
+
+		if (Crossover.Mate != INDEX_NONE)
+		{
+			if (Crossover.Mate < 0 || Crossover.Mate >= Num) return false;
+
+			const int32 MateNum = Entities[Crossover.Mate]->GetGenomeSpan().Num;
+
+			if (Crossover.Start < 0 || Crossover.Start > Crossover.End ||
+				Crossover.End > FMath::Min(ParentNum, MateNum))
+				return false;
+		}
+
+		const int32 EditStart = Recorded.EditStart[i], EditEnd = Recorded.EditStart[i + 1];
+		if (EditStart < 0 || EditStart > EditEnd) return false;
+
+		int32 GeneNum = ParentNum;
+		bool bInserted = false;
+
+		for (int32 Edit = EditStart; Edit < EditEnd; Edit++)
+		{
+			const FAIGenomeEdit& GenomeEdit = Recorded.Edits[Edit];
+
+			switch (GenomeEdit.Kind)
+			{
+			case EAIGenomeEdit::Flip:
+				if (GenomeEdit.Position < 0 || GenomeEdit.Position >= (int64)GeneNum * 32) return false;
+				break;
+			case EAIGenomeEdit::Insert:
+				if (bInserted || GenomeEdit.Position < 0 || GenomeEdit.Position > GeneNum || GeneNum >= Room)
+					return false;
+				bInserted = true;
+				GeneNum++;
+				break;
+			case EAIGenomeEdit::Delete:
+				if (GenomeEdit.Position < 0 || GenomeEdit.Position >= GeneNum || GeneNum <= 1) return false;
+				GeneNum--;
+				break;
+			default:
+				return false;
+			}
+		}
+	}
+
+	return RandomIndex == Recorded.RandomNum.Num() && RandomGeneNum == Recorded.RandomGenes.Num();
+}
+
+void FAIGenerationEngine::Replay(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+                                 const FAIGenerationParams& Params, const FAIGenerationDelta& Recorded)
+{
+	const int32 Num = Entities.Num();
+
+	Survived = Recorded.Survived;
+	ParentOf = Recorded.ParentOf;
+	Children.SetNumUninitialized(Num);
+
+	int32 RandomIndex = 0;
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (ParentOf[i] == INDEX_NONE) Children[i].Num = Recorded.RandomNum[RandomIndex++];
+		else Children[i].Num = Entities[ParentOf[i]]->GetGenomeSpan().Num;
+	}
+
+	FAIGene* Back = LayoutChildren(Arena, Params);
+	const FAIGene* RandomGenes = Recorded.RandomGenes.GetData();
+
+	Signatures.SetNumUninitialized(Num);
+
+	{
+		const FAIGenomeArena::FReadScope ReadScope(Arena);
+
+		for (int32 i = 0; i < Num; i++)
+		{
+			FAIGenomeSpan& Child = Children[i];
+			FAIGene* Genes = Back + Child.Offset;
+
+			if (ParentOf[i] == INDEX_NONE)
+			{
+				FMemory::Memcpy(Genes, RandomGenes, Child.Num * sizeof(FAIGene));
+				RandomGenes += Child.Num;
+			}
+			else
+			{
+				const FAICrossover& Crossover = Recorded.Crossovers[i];
+
+				Recombine(Genes, Arena.Get(Entities[ParentOf[i]]->GetGenomeSpan()),
+				          Crossover.Mate == INDEX_NONE ? TArrayView<const FAIGene>()
+				                                       : Arena.Get(Entities[Crossover.Mate]->GetGenomeSpan()),
+				          Crossover);
+
+				const int32 EditStart = Recorded.EditStart[i];
+				const TArrayView<const FAIGenomeEdit> Edits(Recorded.Edits.GetData() + EditStart,
+				                                            Recorded.EditStart[i + 1] - EditStart);
+
+				FAIGenomeKernels::ApplyEdits(Genes, Child.Num, Edits);
+			}
+
+			FAIGenomeKernels::Sign(TArrayView<const FAIGene>(Genes, Child.Num), Signatures[i]);
+		}
+	}
+
+	Arena.Swap();
+	Generation = Recorded.Generation;
+
+	// Later replays copy from these genomes
+	for (int32 i = 0; i < Num; i++) Entities[i]->SetGenome(Children[i]);
+}
+
+void FAIGenerationEngine::Finish(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities,
+                                 const FAIGenomeArena& Arena, const FAIGenerationParams& Params)
+{
+	const FAIGenomeArena::FReadScope ReadScope(Arena);
+	const int32 Num = Entities.Num();
+
+	// Signed by the reproduction kernel
+	check(Signatures.Num() == Num);
+
+	// Rewiring, exact copies of a genome share the brain wired for the first of them
+	Genomes.Reset();
+	Nets.Reset();
+	WiredFrom.SetNumUninitialized(Num);
+	FirstOfHash.Reset();
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		Entities[i]->SetGenome(Children[i]);
+		WiredFrom[i] = i;
+
+		const TArrayView<const FAIGene> Genome = Arena.Get(Children[i]);
+
+		if (const int32* First = FirstOfHash.Find(Signatures[i].Hash))
+		{
+			const TArrayView<const FAIGene> FirstGenome = Arena.Get(Children[*First]);
+
+			if (FirstGenome.Num() == Genome.Num() &&
+				FMemory::Memcmp(FirstGenome.GetData(), Genome.GetData(), Genome.Num() * sizeof(FAIGene)) == 0)
+			{
+				WiredFrom[i] = *First;
+				continue;
+			}
+		}
+		else FirstOfHash.Add(Signatures[i].Hash, i);
+
+		Genomes.Add(Genome);
+		Nets.Add(&Entities[i]->GetNeuralNet());
+	}
+
+	FAIBrain::WireBatch(Genomes, Params.MaxNumberNeurons, Nets);
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (WiredFrom[i] != i) Entities[i]->GetNeuralNet() = Entities[WiredFrom[i]]->GetNeuralNet();
+	}
+
+	// Actors are only moved on the game thread. Streams restart from the generation so a turnover can be
+	// redone from its recorded decisions alone
+	for (int32 i = 0; i < Num; i++)
+		Entities[i]->StartGeneration(Survived[i], HashCombine(HashCombine(Seed, Generation), i));
+}
+
+void FAIGenerationEngine::Sign(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, const FAIGenomeArena& Arena)
+{
+	const FAIGenomeArena::FReadScope ReadScope(Arena);
+
+	Signatures.SetNumUninitialized(Entities.Num());
+
+	ParallelFor(Entities.Num(), [&](int32 i)
+	{
+		FAIGenomeKernels::Sign(Arena.Get(Entities[i]->GetGenomeSpan()), Signatures[i]);
+	});
+}
+
+FAIGene* FAIGenerationEngine::LayoutChildren(FAIGenomeArena& Arena, const FAIGenerationParams& Params)
+{
+	int32 BackNum = 0;
+
+	for (FAIGenomeSpan& Child : Children)
+	{
+		Child.Offset = BackNum;
+		BackNum += Child.Num + (Child.Num < Params.GenomeMaxLength ? 1 : 0);
+	}
+
+	return Arena.ResetBack(BackNum);
+}
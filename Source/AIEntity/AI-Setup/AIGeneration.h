@@ -0,0 +1,246 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+#include "AIGenomeArena.h"
+#include "AIGenomeKernels.h"
+#include "AISpatialGrid.h"
+#include "AIPareto.h"
+
+class AAIEntityCharacter;
+
+/** Objectives the multi-objective selection trades off, all maximized and in the range 0.0..1.0 */
+enum class EAIObjective : uint8
+{
+	/** Alive and meeting the survival criterion */
+	Survival,
+
+	/** Diagonal of the known space the entity covered */
+	Exploration,
+
+	/** Health and stamina left */
+	Energy,
+
+	/** Rarity of the species of the entity */
+	Diversity,
+
+	/** Distance of the behavior of the entity to its nearest behaviors, 0.0 without novelty search */
+	Novelty
+};
+
+static constexpr int32 AIObjectiveNum = (int32)EAIObjective::Novelty + 1;
+
+/** Rules a generation is run and turned over with */
+struct FAIGenerationParams
+{
+	/** Steps every entity takes before the generation ends */
+	unsigned StepsPerGeneration = 300;
+
+	/** Length of the random genomes made when nobody survives */
+	int32 GenomeInitialLengthMin = 24;
+	int32 GenomeInitialLengthMax = 24;
+
+	/** Insertions never grow a genome past this length */
+	int32 GenomeMaxLength = 300;
+
+	uint32 MaxNumberNeurons = 40;
+
+	double PointMutationRate = 0.001;
+	double GeneInsertionDeletionRate = 0.0;
+	double DeletionRatio = 0.5;
+
+	/** Distance to an interested likeness target an entity has to end the generation within */
+	float SurvivalDistance = 500.0f;
+
+	/** Surviving pheromone emitters pair up and their children mix the genomes of both */
+	bool bMating = false;
+
+	/** Emitters further apart never pair */
+	float MateDistance = 1000.0f;
+
+	/** Rounds of mutual nearest matching, emitters left unpaired reproduce asexually */
+	int32 MatingRounds = 4;
+
+	/** Every alive entity can be a parent, picked by crowded tournaments over its Pareto front */
+	bool bMultiObjective = false;
+};
+
+/** Genes a child took from the mate of its parent, the rest are from the parent */
+struct FAICrossover
+{
+	/** Entity the genes came from, INDEX_NONE for asexual children */
+	int32 Mate = INDEX_NONE;
+
+	/** First gene taken from the mate */
+	int32 Start = 0;
+
+	/** Gene after the last one taken from the mate */
+	int32 End = 0;
+};
+
+/** Everything a turnover decided, enough to redo it without any random stream */
+struct FAIGenerationDelta
+{
+	uint32 Generation = 0;
+
+	TArray<bool> Survived;
+
+	/** Entity each child copied its genome from, INDEX_NONE for random genomes */
+	TArray<int32> ParentOf;
+
+	/** Crossover of each child, made before its mutations */
+	TArray<FAICrossover> Crossovers;
+
+	/** First edit of each child, one extra element closes the last child */
+	TArray<int32> EditStart;
+
+	TArray<FAIGenomeEdit> Edits;
+
+	/** Length of each random genome, in entity order */
+	TArray<int32> RandomNum;
+
+	TArray<FAIGene> RandomGenes;
+};
+
+/**
+ * Ends a generation: picks a parent for every entity among the survivors and gives it a mutated copy
+ * of the parent genome, in parallel over the population
+ */
+class FAIGenerationEngine
+{
+public:
+	/**
+	 * Turn the population over to the next generation, must run on the game thread
+	 *
+	 * @param Entities Whole population
+	 * @param Arena Genomes of the population
+	 * @param Params Rules of the generation
+	 * @param Survives If each entity is alive and meets the survival criterion
+	 * @param Objectives AIObjectiveNum objectives per entity, only read for multi-objective selection
+	 */
+	void Turnover(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+	              const FAIGenerationParams& Params, TArrayView<const bool> Survives,
+	              TArrayView<const float> Objectives = TArrayView<const float>());
+
+	/**
+	 * Replace some entities without a generation barrier, each gets a mutated copy of the genome of a
+	 * fit entity outside the replaced ones and starts over. Every population worth of replacements
+	 * counts as one generation. Must run on the game thread.
+	 *
+	 * @param Entities Whole population
+	 * @param Arena Genomes of the population, children are added to the current generation
+	 * @param Params Rules of the generation
+	 * @param Survives If each entity is alive and fit, parents are picked among the fit ones if any is
+	 * @param Slots Entities to replace, without duplicates
+	 * @return Generations completed by these replacements
+	 */
+	int32 Replace(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+	              const FAIGenerationParams& Params, TArrayView<const bool> Survives, TArrayView<const int32> Slots);
+
+	/**
+	 * If a recorded turnover fits the current genomes and rules, so replaying it stays inside every child slot
+	 *
+	 * @param Entities Whole population, in the order of the recording
+	 * @param Params Rules of the generation
+	 * @param Recorded Recorded turnover
+	 */
+	static bool CanReplay(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, const FAIGenerationParams& Params,
+	                      const FAIGenerationDelta& Recorded);
+
+	/**
+	 * Redo a recorded turnover that CanReplay accepted, the generation only starts once Finish is called
+	 *
+	 * @param Entities Whole population, in the order of the recording
+	 * @param Arena Genomes of the population
+	 * @param Params Rules of the generation
+	 * @param Recorded Recorded turnover
+	 */
+	void Replay(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+	            const FAIGenerationParams& Params, const FAIGenerationDelta& Recorded);
+
+	/**
+	 * Rewire every brain and start the generation on the entities after one or more replays
+	 *
+	 * @param Entities Whole population
+	 * @param Arena Genomes of the population
+	 * @param Params Rules of the generation
+	 */
+	void Finish(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, const FAIGenomeArena& Arena,
+	            const FAIGenerationParams& Params);
+
+	/**
+	 * Sign the genomes the entities hold, for genomes that were not reproduced by a turnover
+	 *
+	 * @param Entities Whole population
+	 * @param Arena Genomes of the population
+	 */
+	void Sign(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, const FAIGenomeArena& Arena);
+
+	uint32 GetGeneration() const { return Generation; }
+
+	/** Seed the entity streams are reseeded from at every turnover */
+	void SetSeed(uint32 InSeed) { Seed = InSeed; }
+
+	/** Keep what every turnover decided in GetLastDelta */
+	void SetRecordDelta(bool bRecord) { bRecordDelta = bRecord; }
+
+	/** Signature of every genome of the current generation, indexed like the entities */
+	TArrayView<const FAIGenomeSignature> GetSignatures() const { return Signatures; }
+
+	/** What the last turnover decided, only filled while recording deltas */
+	const FAIGenerationDelta& GetLastDelta() const { return Delta; }
+
+	void SetGeneration(uint32 InGeneration) { Generation = InGeneration; }
+
+private:
+	uint32 Generation = 0;
+
+	uint32 Seed = 0;
+
+	bool bRecordDelta = false;
+
+	FAIGenerationDelta Delta;
+
+	/** Per entity scratch kept between turnovers */
+	TArray<bool> Survived;
+	TArray<int32> Parents;
+	TArray<int32> ParentOf;
+	TArray<FAIGenomeSpan> Children;
+	TArray<TArrayView<const FAIGene>> Genomes;
+	TArray<FAINeuralNet*> Nets;
+	TArray<FAIGenomeSignature> Signatures;
+	TArray<int32> WiredFrom;
+	TMap<uint64, int32> FirstOfHash;
+	TArray<TArray<FAIGenomeEdit>> ChildEdits;
+	TArray<FAICrossover> Crossovers;
+	TArray<int32> MateOf;
+	TArray<int32> Emitters;
+	TArray<FVector> EmitterLocations;
+	TArray<int32> Candidates;
+	TMap<const AActor*, int32> EmitterOf;
+	FAISpatialGrid MateGrid;
+
+	FAIParetoRanking Pareto;
+
+	/** Replacements since the last generation counted without a barrier */
+	int32 Births = 0;
+
+	/** Per replacement scratch */
+	TArray<bool> Replaced;
+	TArray<int32> SlotParents;
+	TArray<FAIGenomeSpan> SlotChildren;
+
+	/** Move every genome into the back buffer of the arena without the gaps replacements left behind */
+	void Compact(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAIGenomeArena& Arena,
+	             const FAIGenerationParams& Params);
+
+	/** Pair surviving pheromone emitters into MateOf and return the number of pairs */
+	int32 PairMates(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, const FAIGenerationParams& Params);
+
+	/** Write a child genome into a buffer as long as the parent, Mate is empty for asexual children */
+	static void Recombine(FAIGene* Genes, TArrayView<const FAIGene> Parent, TArrayView<const FAIGene> Mate,
+	                      const FAICrossover& Crossover);
+
+	/** Place every child in the back buffer of the arena with room for an insertion */
+	FAIGene* LayoutChildren(FAIGenomeArena& Arena, const FAIGenerationParams& Params);
+};
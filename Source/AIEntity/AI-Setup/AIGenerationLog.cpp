@@ -0,0 +1,272 @@
+#include "AIGenerationLog.h"
+#include "../AIEntity.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/** Start of every generation block */
+struct FAIGenerationLogBlock
+{
+	uint32 Generation;
+	int32 EntityNum;
+	int32 ColumnNum;
+};
+
+/** Start of every column inside a block */
+struct FAIGenerationLogColumn
+{
+	int32 RawSize;
+	int32 CompressedSize;
+};
+
+void FAIGenerationColumns::SetNum(int32 Num)
+{
+	SuccessRate.SetNumUninitialized(Num);
+	GenomeLength.SetNumUninitialized(Num);
+	WiredSensors.SetNumUninitialized(Num);
+	WiredActions.SetNumUninitialized(Num);
+}
+
+float FAIGenerationColumns::SurvivalRate() const
+{
+	int32 Survivors = 0;
+
+	for (uint8 Flag : SuccessRate) Survivors += Flag;
+
+	return SuccessRate.Num() ? (float)Survivors / SuccessRate.Num() : 0.0f;
+}
+
+bool FAIGenerationLogWriter::Open(const FString& Path, bool bAppend)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+	const FAIGenerationLogHeader Header;
+
+	if (bAppend)
+	{
+		TArray<uint8> Existing;
+		FAIGenerationLogHeader ExistingHeader;
+
+		bAppend = FFileHelper::LoadFileToArray(Existing, *Path, FILEREAD_Silent) &&
+			Existing.Num() >= (int32)sizeof(ExistingHeader);
+
+		if (bAppend)
+		{
+			FMemory::Memcpy(&ExistingHeader, Existing.GetData(), sizeof(ExistingHeader));
+			bAppend = ExistingHeader.Matches(Header);
+		}
+
+		// A block torn by a crash would hide every generation appended after it from the reader
+		if (bAppend)
+		{
+			const int64 CompleteEnd = FAIGenerationLogReader::ReadBlocks(Existing, [](const FAIGenerationColumns&) {});
+
+			if (CompleteEnd < Existing.Num() &&
+				!FFileHelper::SaveArrayToFile(TArrayView<const uint8>(Existing.GetData(), CompleteEnd), *Path))
+			{
+				UE_LOG(LogAIEntity, Warning, TEXT("Could not drop the torn end of generation log %s"), *Path);
+				bAppend = false;
+			}
+		}
+	}
+
+	FileHandle.Reset(PlatformFile.OpenWrite(*Path, bAppend));
+
+	if (!FileHandle)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Could not open generation log %s"), *Path);
+		return false;
+	}
+
+	if (bAppend) FileHandle->SeekFromEnd(0);
+	else FileHandle->Write((const uint8*)&Header, sizeof(Header));
+
+	bStopping = false;
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("AIGenerationLog"), 0, TPri_BelowNormal);
+
+	return true;
+}
+
+void FAIGenerationLogWriter::Close()
+{
+	if (!Thread) return;
+
+	bStopping = true;
+	WorkEvent->Trigger();
+	Thread->WaitForCompletion();
+
+	delete Thread;
+	Thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+
+	FileHandle.Reset();
+}
+
+void FAIGenerationLogWriter::Submit(FAIGenerationColumns&& Columns)
+{
+	if (!Thread) return;
+
+	Queue.Enqueue(MakeUnique<FAIGenerationColumns>(MoveTemp(Columns)));
+	WorkEvent->Trigger();
+}
+
+uint32 FAIGenerationLogWriter::Run()
+{
+	for (;;)
+	{
+		TUniquePtr<FAIGenerationColumns> Columns;
+
+		while (Queue.Dequeue(Columns)) WriteGeneration(*Columns);
+
+		FileHandle->Flush();
+
+		if (bStopping) break;
+
+		WorkEvent->Wait();
+	}
+
+	// Columns queued right before the close
+	TUniquePtr<FAIGenerationColumns> Columns;
+
+	while (Queue.Dequeue(Columns)) WriteGeneration(*Columns);
+
+	FileHandle->Flush();
+
+	return 0;
+}
+
+void FAIGenerationLogWriter::WriteGeneration(const FAIGenerationColumns& Columns)
+{
+	const TArrayView<const uint8> Raw[] = {
+		TArrayView<const uint8>(Columns.SuccessRate.GetData(), Columns.SuccessRate.NumBytes()),
+		TArrayView<const uint8>((const uint8*)Columns.GenomeLength.GetData(), Columns.GenomeLength.NumBytes()),
+		TArrayView<const uint8>((const uint8*)Columns.WiredSensors.GetData(), Columns.WiredSensors.NumBytes()),
+		TArrayView<const uint8>((const uint8*)Columns.WiredActions.GetData(), Columns.WiredActions.NumBytes())
+	};
+
+	const FAIGenerationLogBlock Block = {Columns.Generation, Columns.Num(), UE_ARRAY_COUNT(Raw)};
+	FileHandle->Write((const uint8*)&Block, sizeof(Block));
+
+	TArray<uint8> Compressed;
+
+	for (const TArrayView<const uint8>& Column : Raw)
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Column.Num());
+		Compressed.SetNumUninitialized(CompressedSize);
+
+		// Stored raw when it does not compress
+		if (!FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, Column.GetData(),
+		                                  Column.Num()) || CompressedSize >= Column.Num())
+		{
+			CompressedSize = Column.Num();
+			FMemory::Memcpy(Compressed.GetData(), Column.GetData(), Column.Num());
+		}
+
+		const FAIGenerationLogColumn Header = {Column.Num(), CompressedSize};
+		FileHandle->Write((const uint8*)&Header, sizeof(Header));
+		FileHandle->Write(Compressed.GetData(), CompressedSize);
+	}
+}
+
+bool FAIGenerationLogReader::Read(const FString& Path, TFunctionRef<void(const FAIGenerationColumns&)> Visit)
+{
+	TArray<uint8> Data;
+
+	if (!FFileHelper::LoadFileToArray(Data, *Path) || Data.Num() < (int32)sizeof(FAIGenerationLogHeader)) return false;
+
+	FAIGenerationLogHeader Header;
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+
+	if (!Header.Matches(FAIGenerationLogHeader())) return false;
+
+	ReadBlocks(Data, Visit);
+
+	return true;
+}
+
+int64 FAIGenerationLogReader::ReadBlocks(TArrayView<const uint8> Data,
+                                         TFunctionRef<void(const FAIGenerationColumns&)> Visit)
+{
+	int64 Cursor = sizeof(FAIGenerationLogHeader), CompleteEnd = Cursor;
+	FAIGenerationColumns Columns;
+
+	while (Cursor + (int64)sizeof(FAIGenerationLogBlock) <= Data.Num())
+	{
+		FAIGenerationLogBlock Block;
+		FMemory::Memcpy(&Block, Data.GetData() + Cursor, sizeof(Block));
+		Cursor += sizeof(Block);
+
+		if (Block.EntityNum < 0) break;
+
+		Columns.Generation = Block.Generation;
+		Columns.SetNum(Block.EntityNum);
+
+		uint8* Targets[] = {
+			Columns.SuccessRate.GetData(),
+			(uint8*)Columns.GenomeLength.GetData(),
+			(uint8*)Columns.WiredSensors.GetData(),
+			(uint8*)Columns.WiredActions.GetData()
+		};
+		const int32 TargetSizes[] = {
+			(int32)Columns.SuccessRate.NumBytes(),
+			(int32)Columns.GenomeLength.NumBytes(),
+			(int32)Columns.WiredSensors.NumBytes(),
+			(int32)Columns.WiredActions.NumBytes()
+		};
+
+		// Columns missing from the block would reach the visitor uninitialized
+		if (Block.ColumnNum < (int32)UE_ARRAY_COUNT(Targets)) break;
+
+		bool bComplete = true;
+
+		for (int32 Column = 0; Column < Block.ColumnNum && bComplete; Column++)
+		{
+			FAIGenerationLogColumn ColumnHeader;
+
+			if (Cursor + (int64)sizeof(ColumnHeader) > Data.Num())
+			{
+				bComplete = false;
+				break;
+			}
+
+			FMemory::Memcpy(&ColumnHeader, Data.GetData() + Cursor, sizeof(ColumnHeader));
+			Cursor += sizeof(ColumnHeader);
+
+			if (ColumnHeader.CompressedSize < 0 || Cursor + ColumnHeader.CompressedSize > Data.Num())
+			{
+				bComplete = false;
+				break;
+			}
+
+			// Columns added by newer versions are skipped
+			if (Column < UE_ARRAY_COUNT(Targets))
+			{
+				if (ColumnHeader.RawSize != TargetSizes[Column]) bComplete = false;
+				else if (ColumnHeader.CompressedSize == ColumnHeader.RawSize)
+					FMemory::Memcpy(Targets[Column], Data.GetData() + Cursor, ColumnHeader.RawSize);
+				else
+					bComplete = FCompression::UncompressMemory(NAME_Zlib, Targets[Column], ColumnHeader.RawSize,
+					                                           Data.GetData() + Cursor,
+					                                           ColumnHeader.CompressedSize);
+			}
+
+			Cursor += ColumnHeader.CompressedSize;
+		}
+
+		// The last generation may be cut short by a crash
+		if (!bComplete) break;
+
+		CompleteEnd = Cursor;
+		Visit(Columns);
+	}
+
+	return CompleteEnd;
+}
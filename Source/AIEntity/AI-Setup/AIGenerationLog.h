@@ -0,0 +1,104 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIFileFormat.h"
+#include "HAL/Runnable.h"
+#include "Containers/Queue.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+/** Per entity columns of one generation */
+struct FAIGenerationColumns
+{
+	uint32 Generation = 0;
+
+	/** SuccessRate of each entity, if it survived the generation before */
+	TArray<uint8> SuccessRate;
+
+	TArray<uint16> GenomeLength;
+
+	/** Sensors wired in each brain, one bit per EAISensory */
+	TArray<uint64> WiredSensors;
+
+	/** Actions wired in each brain, one bit per EAIActions */
+	TArray<uint64> WiredActions;
+
+	void SetNum(int32 Num);
+
+	int32 Num() const { return SuccessRate.Num(); }
+
+	/** Share of the entities that survived */
+	float SurvivalRate() const;
+};
+
+/** Start of a generation log, the generation blocks follow */
+struct FAIGenerationLogHeader : FAIFileHeader
+{
+	static constexpr uint32 MagicValue = 0x4C474941; // "AIGL"
+
+	static constexpr uint32 VersionValue = 1;
+
+	FAIGenerationLogHeader() : FAIFileHeader{MagicValue, VersionValue} {}
+};
+
+/** Appends the generation columns to a local file on a background thread, each compressed on its own */
+class FAIGenerationLogWriter : public FRunnable
+{
+public:
+	virtual ~FAIGenerationLogWriter() override { Close(); }
+
+	/**
+	 * Start a new log or continue one
+	 *
+	 * @param Path File to write
+	 * @param bAppend Continue the log in the file, a file that is not a log is still replaced
+	 * @return If the file could be opened
+	 */
+	bool Open(const FString& Path, bool bAppend = false);
+
+	/** Write out what is queued and stop the thread */
+	void Close();
+
+	bool IsOpen() const { return Thread != nullptr; }
+
+	/** Queue the columns of a generation for the background thread */
+	void Submit(FAIGenerationColumns&& Columns);
+
+	virtual uint32 Run() override;
+
+private:
+	TUniquePtr<IFileHandle> FileHandle;
+
+	FRunnableThread* Thread = nullptr;
+
+	/** Wakes the thread when columns are queued or the log closes */
+	FEvent* WorkEvent = nullptr;
+
+	TQueue<TUniquePtr<FAIGenerationColumns>, EQueueMode::Spsc> Queue;
+
+	std::atomic<bool> bStopping = false;
+
+	/** Compress and append one generation */
+	void WriteGeneration(const FAIGenerationColumns& Columns);
+};
+
+/** Reads a generation log one generation at a time */
+struct FAIGenerationLogReader
+{
+	/**
+	 * Visit every complete generation of a log
+	 *
+	 * @param Path File to read
+	 * @param Visit Called with the columns of every generation in order
+	 * @return If the file is a generation log
+	 */
+	static bool Read(const FString& Path, TFunctionRef<void(const FAIGenerationColumns&)> Visit);
+
+	/**
+	 * Visit every complete generation of the blocks following the header
+	 *
+	 * @param Data Whole log, header included
+	 * @param Visit Called with the columns of every generation in order
+	 * @return Offset after the last complete block
+	 */
+	static int64 ReadBlocks(TArrayView<const uint8> Data, TFunctionRef<void(const FAIGenerationColumns&)> Visit);
+};
@@ -0,0 +1,34 @@
+#include "AIGenomeArena.h"
+
+FAIGenomeSpan FAIGenomeArena::Add(TArrayView<const FAIGene> Genes)
+{
+	CheckNoReaders();
+
+	const FAIGenomeSpan Span = {Buffers[Front].Num(), Genes.Num()};
+
+	Buffers[Front].Append(Genes.GetData(), Genes.Num());
+
+	return Span;
+}
+
+FAIGenomeSpan FAIGenomeArena::Allocate(int32 Num)
+{
+	CheckNoReaders();
+
+	const FAIGenomeSpan Span = {Buffers[Front].Num(), Num};
+
+	Buffers[Front].AddUninitialized(Num);
+
+	return Span;
+}
+
+FAIGene* FAIGenomeArena::ResetBack(int32 Num)
+{
+	TArray<FAIGene>& Back = Buffers[Front ^ 1];
+
+	// Keeps the allocation of two generations ago
+	Back.Reset();
+	Back.AddUninitialized(Num);
+
+	return Back.GetData();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+
+/**
+ * Genomes of the whole population in two contiguous buffers, the current generation and the children
+ * of the next, swapped at turnover. Views into the current generation are held under a read scope.
+ */
+class FAIGenomeArena
+{
+public:
+	/** Asserts the current generation stays in place while views into it are held, game thread only */
+	class FReadScope
+	{
+	public:
+		explicit FReadScope(const FAIGenomeArena& InArena) : Arena(InArena) { Arena.ReadScopes++; }
+
+		~FReadScope() { Arena.ReadScopes--; }
+
+		UE_NONCOPYABLE(FReadScope);
+
+	private:
+		const FAIGenomeArena& Arena;
+	};
+
+	/** Append a genome to the current generation */
+	FAIGenomeSpan Add(TArrayView<const FAIGene> Genes);
+
+	/** Make room for a genome in the current generation, its genes are left uninitialized */
+	FAIGenomeSpan Allocate(int32 Num);
+
+	/** Writable genes of a genome of the current generation, only valid until the next Add, Allocate, Load or Swap */
+	FAIGene* GetMutable(const FAIGenomeSpan& Span) { return Buffers[Front].GetData() + Span.Offset; }
+
+	/** Genes of a genome of the current generation, only valid until the next Add, Allocate, Load or Swap */
+	TArrayView<const FAIGene> Get(const FAIGenomeSpan& Span) const
+	{
+		return TArrayView<const FAIGene>(Buffers[Front].GetData() + Span.Offset, Span.Num);
+	}
+
+	/** Empty the back buffer, size it for a number of genes and return its first gene */
+	FAIGene* ResetBack(int32 Num);
+
+	/** Replace the current generation with genes loaded from elsewhere, spans into them stay valid */
+	void Load(TArrayView<const FAIGene> Genes)
+	{
+		CheckNoReaders();
+		Buffers[Front] = Genes;
+	}
+
+	/** Make the back buffer the current generation */
+	void Swap()
+	{
+		CheckNoReaders();
+		Front ^= 1;
+	}
+
+	/** Genes in the current generation, including the gaps left by resized genomes */
+	int32 Num() const { return Buffers[Front].Num(); }
+
+private:
+	TArray<FAIGene> Buffers[2];
+
+	int32 Front = 0;
+
+	mutable int32 ReadScopes = 0;
+
+	void CheckNoReaders() const
+	{
+		checkf(ReadScopes == 0, TEXT("Genome arena changed while %d read scopes hold views into it"), ReadScopes);
+	}
+};
@@ -0,0 +1,186 @@
+#include "AIGenomeKernels.h"
+#include "Math/VectorRegister.h"
+#include "Hash/CityHash.h"
+
+int32 FAIGenomeKernels::CountEqualGenes(const FAIGene* A, const FAIGene* B, int32 Num)
+{
+	int32 Equal = 0;
+	int32 i = 0;
+
+	// Four packed genes per register, one lane mask bit per equal gene
+	for (; i + 4 <= Num; i += 4)
+	{
+		const VectorRegister4Int WordsA = VectorIntLoad(A + i);
+		const VectorRegister4Int WordsB = VectorIntLoad(B + i);
+
+		Equal += FPlatformMath::CountBits(VectorMaskBits(VectorCastIntToFloat(VectorIntCompareEQ(WordsA, WordsB))));
+	}
+
+	// Remaining genes
+	for (; i < Num; i++)
+	{
+		if (A[i].ToWord() == B[i].ToWord()) Equal++;
+	}
+
+	return Equal;
+}
+
+float FAIGenomeKernels::Similarity(TArrayView<const FAIGene> A, TArrayView<const FAIGene> B)
+{
+	const int32 Longest = FMath::Max(A.Num(), B.Num());
+
+	if (Longest == 0) return 1.0f;
+
+	return (float)CountEqualGenes(A.GetData(), B.GetData(), FMath::Min(A.Num(), B.Num())) / Longest;
+}
+
+void FAIGenomeKernels::RandomGenes(FAIGene* Genes, int32 Num, FRandomStream& Random)
+{
+	// Four xorshift generators side by side, seeded from the entity stream so genomes stay deterministic
+	VectorRegister4Int State = MakeVectorRegisterInt(
+		(int32)(Random.GetUnsignedInt() | 1),
+		(int32)(Random.GetUnsignedInt() | 1),
+		(int32)(Random.GetUnsignedInt() | 1),
+		(int32)(Random.GetUnsignedInt() | 1)
+	);
+
+	int32 i = 0;
+
+	for (; i + 4 <= Num; i += 4)
+	{
+		State = VectorIntXor(State, VectorShiftLeftImm(State, 13));
+		State = VectorIntXor(State, VectorShiftRightImmLogical(State, 17));
+		State = VectorIntXor(State, VectorShiftLeftImm(State, 5));
+
+		VectorIntStore(State, Genes + i);
+	}
+
+	// Remaining genes
+	for (; i < Num; i++) Genes[i] = FAIGene::FromWord(Random.GetUnsignedInt());
+}
+
+void FAIGenomeKernels::Mutate(FAIGene* Genes, int32& Num, double PointMutationRate, double InsertionDeletionRate,
+                              double DeletionRatio, int32 MaxLength, FRandomStream& Random,
+                              TArray<FAIGenomeEdit>* OutEdits)
+{
+	TArray<FAIGenomeEdit, TInlineAllocator<8>> Edits;
+
+	if (Random.GetFraction() < InsertionDeletionRate)
+	{
+		if (Random.GetFraction() < DeletionRatio)
+		{
+			// A genome never loses its last gene
+			if (Num > 1) Edits.Add({EAIGenomeEdit::Delete, Random.RandHelper(Num), 0});
+		}
+		else if (Num < MaxLength)
+		{
+			const int32 At = Random.RandHelper(Num + 1);
+			Edits.Add({EAIGenomeEdit::Insert, At, Random.GetUnsignedInt()});
+		}
+	}
+
+	// Same number of flips per gene on average, spread over its 32 bits
+	const double BitRate = PointMutationRate / 32.0;
+
+	if (BitRate > 0.0)
+	{
+		// Length after the insertion or deletion
+		const int32 FinalNum = Num + (Edits.Num() ? (Edits[0].Kind == EAIGenomeEdit::Insert ? 1 : -1) : 0);
+		const int64 Bits = (int64)FinalNum * 32;
+		const double LogKeep = FMath::Loge(1.0 - FMath::Min(BitRate, 0.999999));
+
+		// Jump straight to the next flipped bit, the gaps between flips are geometrically distributed
+		for (int64 Bit = -1;;)
+		{
+			const double Fraction = FMath::Max(Random.GetFraction(), UE_SMALL_NUMBER);
+			Bit += 1 + (int64)(FMath::Loge(Fraction) / LogKeep);
+
+			if (Bit >= Bits) break;
+
+			Edits.Add({EAIGenomeEdit::Flip, (int32)Bit, 0});
+		}
+	}
+
+	ApplyEdits(Genes, Num, Edits);
+
+	if (OutEdits) OutEdits->Append(Edits);
+}
+
+void FAIGenomeKernels::ApplyEdits(FAIGene* Genes, int32& Num, TArrayView<const FAIGenomeEdit> Edits)
+{
+	for (const FAIGenomeEdit& Edit : Edits)
+	{
+		switch (Edit.Kind)
+		{
+		case EAIGenomeEdit::Flip:
+			{
+				FAIGene& Gene = Genes[Edit.Position / 32];
+				Gene = FAIGene::FromWord(Gene.ToWord() ^ (1u << (Edit.Position % 32)));
+				break;
+			}
+		case EAIGenomeEdit::Insert:
+			{
+				FMemory::Memmove(Genes + Edit.Position + 1, Genes + Edit.Position,
+				                 (Num - Edit.Position) * sizeof(FAIGene));
+				Genes[Edit.Position] = FAIGene::FromWord(Edit.Word);
+				Num++;
+				break;
+			}
+		case EAIGenomeEdit::Delete:
+			{
+				FMemory::Memmove(Genes + Edit.Position, Genes + Edit.Position + 1,
+				                 (Num - Edit.Position - 1) * sizeof(FAIGene));
+				Num--;
+				break;
+			}
+		}
+	}
+}
+
+float FAIGenomeSignature::Likeness(const FAIGenomeSignature& Other) const
+{
+	int32 Equal = 0;
+
+	for (int32 i = 0; i < AIMinHashNum; i++) Equal += MinHash[i] == Other.MinHash[i];
+
+	return (float)Equal / AIMinHashNum;
+}
+
+// SplitMix64 finalizer
+static uint64 MixBits(uint64 Value)
+{
+	Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+	return Value ^ (Value >> 31);
+}
+
+// One seed per MinHash function, consecutive SplitMix64 outputs so no function is derived from another
+struct FAIMinHashSeeds
+{
+	uint64 Values[AIMinHashNum];
+
+	FAIMinHashSeeds()
+	{
+		for (int32 k = 0; k < AIMinHashNum; k++) Values[k] = MixBits((k + 1) * 0x9E3779B97F4A7C15ull);
+	}
+};
+
+static const FAIMinHashSeeds MinHashSeeds;
+
+void FAIGenomeKernels::Sign(TArrayView<const FAIGene> Genes, FAIGenomeSignature& OutSignature)
+{
+	OutSignature.Hash = CityHash64((const char*)Genes.GetData(), Genes.Num() * sizeof(FAIGene));
+
+	for (uint32& Value : OutSignature.MinHash) Value = MAX_uint32;
+
+	for (const FAIGene& Gene : Genes)
+	{
+		const uint64 Word = Gene.ToWord();
+
+		for (int32 k = 0; k < AIMinHashNum; k++)
+		{
+			const uint32 Value = (uint32)MixBits(Word ^ MinHashSeeds.Values[k]);
+			OutSignature.MinHash[k] = FMath::Min(OutSignature.MinHash[k], Value);
+		}
+	}
+}
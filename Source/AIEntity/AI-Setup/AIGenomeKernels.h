@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+#include "Math/RandomStream.h"
+
+/** Similarity of the last compared pair of genomes, reused while facing the same entity in the same step */
+struct FAIGenomeSimilarityCache
+{
+	const AActor* Other = nullptr;
+
+	uint32 Epoch = MAX_uint32;
+
+	/** Similarity in the range 0.0..1.0 */
+	float Value = 0.0f;
+};
+
+/** Kind of change a mutation made to a genome */
+enum class EAIGenomeEdit : uint8
+{
+	Flip,
+	Insert,
+	Delete
+};
+
+/** Single change a mutation made to a genome, enough to redo the mutation without its random stream */
+struct FAIGenomeEdit
+{
+	EAIGenomeEdit Kind;
+
+	/** Bit flipped or gene inserted or deleted */
+	int32 Position;
+
+	uint32 Word;
+};
+
+/** Hash values in a MinHash sketch */
+static constexpr int32 AIMinHashNum = 16;
+
+/** Identity of a genome: an exact hash of its genes and a MinHash sketch of its gene set */
+struct FAIGenomeSignature
+{
+	uint64 Hash = 0;
+
+	/** Smallest hash of any gene under each hash function, equal values estimate the gene set overlap */
+	uint32 MinHash[AIMinHashNum];
+
+	/** Estimated Jaccard similarity of the gene sets in the range 0.0..1.0 */
+	float Likeness(const FAIGenomeSignature& Other) const;
+};
+
+/** Bulk kernels over genomes stored as packed 32-bit gene words */
+struct FAIGenomeKernels
+{
+	/**
+	 * Count the genes that are equal at the same position, four words per compare
+	 *
+	 * @param A First genome
+	 * @param B Second genome
+	 * @param Num Number of genes to compare, must fit in both genomes
+	 */
+	static int32 CountEqualGenes(const FAIGene* A, const FAIGene* B, int32 Num);
+
+	/**
+	 * Similarity of two genomes of any length in the range 0.0..1.0, positions missing from the
+	 * shorter genome count as different
+	 *
+	 * @param A First genome
+	 * @param B Second genome
+	 */
+	static float Similarity(TArrayView<const FAIGene> A, TArrayView<const FAIGene> B);
+
+	/**
+	 * Fill a buffer with random genes, four genes per step
+	 *
+	 * @param Genes Buffer to fill
+	 * @param Num Number of genes to write
+	 * @param Random Stream of the entity the genome belongs to
+	 */
+	static void RandomGenes(FAIGene* Genes, int32 Num, FRandomStream& Random);
+
+	/**
+	 * Apply point mutations and an insertion or deletion to a genome in place. The buffer must have
+	 * room for one more gene while the genome is shorter than MaxLength.
+	 *
+	 * @param Genes Genome to mutate
+	 * @param Num Number of genes, updated on insertion or deletion
+	 * @param PointMutationRate Average number of bits flipped per gene
+	 * @param InsertionDeletionRate Chance of the genome to get a gene inserted or deleted
+	 * @param DeletionRatio Chance of a deletion instead of an insertion
+	 * @param MaxLength Insertions never grow the genome past this length
+	 * @param Random Stream of the entity the genome belongs to
+	 * @param OutEdits Changes made, in the order they were made, if not null
+	 */
+	static void Mutate(FAIGene* Genes, int32& Num, double PointMutationRate, double InsertionDeletionRate,
+	                   double DeletionRatio, int32 MaxLength, FRandomStream& Random,
+	                   TArray<FAIGenomeEdit>* OutEdits = nullptr);
+
+	/**
+	 * Redo the changes of a mutation, same buffer requirements as Mutate
+	 *
+	 * @param Genes Genome to change
+	 * @param Num Number of genes, updated on insertion or deletion
+	 * @param Edits Changes in the order they were made
+	 */
+	static void ApplyEdits(FAIGene* Genes, int32& Num, TArrayView<const FAIGenomeEdit> Edits);
+
+	/** Hash a genome and sketch its gene set */
+	static void Sign(TArrayView<const FAIGene> Genes, FAIGenomeSignature& OutSignature);
+};
@@ -0,0 +1,54 @@
+#include "AIInteraction.h"
+#include "AIEntityCharacter.h"
+#include "AITraits.h"
+#include "../AIEntity.h"
+
+DECLARE_CYCLE_STAT(TEXT("Interaction Commit"), STAT_AIInteractionCommit, STATGROUP_AIEntity);
+
+void FAIInteractionQueue::Commit(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAITraitStore& Traits)
+{
+	if (Pending.IsEmpty()) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_AIInteractionCommit);
+
+	// Entities that left or moved in the population since emitting, pointers are only compared as they may
+	// dangle
+	auto InPopulation = [Entities](const AAIEntityCharacter* Entity, int32 Index)
+	{
+		return Entities.IsValidIndex(Index) && Entities[Index] == Entity;
+	};
+
+	Pending.RemoveAllSwap([&InPopulation](const FAIInteractionIntent& Candidate)
+	{
+		return !InPopulation(Candidate.Source, Candidate.SourceIndex) ||
+			!InPopulation(Candidate.Target, Candidate.TargetIndex);
+	});
+
+	// Grouped by target and kind, the first source of each group wins
+	Pending.Sort([](const FAIInteractionIntent& A, const FAIInteractionIntent& B)
+	{
+		if (A.TargetIndex != B.TargetIndex) return A.TargetIndex < B.TargetIndex;
+		if (A.Kind != B.Kind) return A.Kind < B.Kind;
+
+		return A.SourceIndex < B.SourceIndex;
+	});
+
+	for (int32 i = 0; i < Pending.Num(); i++)
+	{
+		const FAIInteractionIntent& Winner = Pending[i];
+
+		if (i > 0 && Pending[i - 1].TargetIndex == Winner.TargetIndex && Pending[i - 1].Kind == Winner.Kind) continue;
+		if (!Winner.Target->IsAlive()) continue;
+
+		// Victims die once the traits step, so kills stay simultaneous
+		if (Winner.Kind == EAIInteraction::Kill) Traits.Damage[Winner.TargetIndex] += Winner.Damage;
+		else Winner.Target->Touched();
+	}
+
+	Pending.Reset();
+}
+
+void FAIInteractionQueue::Reset()
+{
+	Pending.Reset();
+}
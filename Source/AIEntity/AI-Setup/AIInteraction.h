@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AAIEntityCharacter;
+class FAITraitStore;
+
+/** What an entity does to the one in front of it */
+enum class EAIInteraction : uint8
+{
+	Touch,
+	Kill
+};
+
+/** Interaction an entity wants to make this step */
+struct FAIInteractionIntent
+{
+	AAIEntityCharacter* Source;
+
+	AAIEntityCharacter* Target;
+
+	/** Population slots of the source and the target when the intent was emitted */
+	int32 SourceIndex;
+
+	int32 TargetIndex;
+
+	EAIInteraction Kind;
+
+	/** Health taken from the target by a kill */
+	float Damage = 1.0f;
+};
+
+/**
+ * Interactions emitted while the entities act, applied in one commit pass once every entity acted.
+ * Conflicts resolve by the order entities joined the population.
+ */
+class FAIInteractionQueue
+{
+public:
+	/** Queue an interaction, must run on the game thread */
+	void Emit(const FAIInteractionIntent& Intent)
+	{
+		check(IsInGameThread());
+		Pending.Add(Intent);
+	}
+
+	/**
+	 * Apply every queued interaction, must run on the game thread
+	 *
+	 * @param Entities Whole population in the order it joined
+	 * @param Traits Traits of the population, kills add to the damage of their victims
+	 */
+	void Commit(TArrayView<const TObjectPtr<AAIEntityCharacter>> Entities, FAITraitStore& Traits);
+
+	/** Drop every queued interaction */
+	void Reset();
+
+private:
+	/** Intents emitted this step, the storage is kept between steps */
+	TArray<FAIInteractionIntent> Pending;
+};
@@ -0,0 +1,285 @@
+#include "AIJournal.h"
+#include "../AIEntity.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+/** Size and checksum in front of every record */
+struct FAIJournalRecordHeader
+{
+	uint32 Size;
+	uint32 Crc;
+};
+
+bool FAIJournal::Open(const FString& Path, uint32 RunSeed, uint32 BaseGeneration)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+	FileHandle.Reset(PlatformFile.OpenWrite(*Path));
+
+	if (!FileHandle)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Could not open journal %s"), *Path);
+		return false;
+	}
+
+	FAIJournalHeader Header;
+	Header.RunSeed = RunSeed;
+	Header.BaseGeneration = BaseGeneration;
+
+	FileHandle->Write((const uint8*)&Header, sizeof(Header));
+	FileHandle->Flush();
+
+	return true;
+}
+
+void FAIJournal::Close()
+{
+	FileHandle.Reset();
+}
+
+void FAIJournal::Append(const FAIGenerationDelta& Delta)
+{
+	if (!FileHandle) return;
+
+	FBitWriter Writer(0, true);
+	Encode(Delta, Writer);
+
+	const FAIJournalRecordHeader Record = {
+		(uint32)Writer.GetNumBytes(),
+		FCrc::MemCrc32(Writer.GetData(), Writer.GetNumBytes())
+	};
+
+	FileHandle->Write((const uint8*)&Record, sizeof(Record));
+	FileHandle->Write(Writer.GetData(), Writer.GetNumBytes());
+
+	// Each generation is on disk before the next one starts
+	FileHandle->Flush();
+}
+
+bool FAIJournal::Read(const FString& Path, FAIJournalHeader& OutHeader,
+                      TFunctionRef<void(const FAIGenerationDelta&)> Visit)
+{
+	TArray<uint8> Data;
+
+	if (!FFileHelper::LoadFileToArray(Data, *Path) || Data.Num() < (int32)sizeof(FAIJournalHeader)) return false;
+
+	FMemory::Memcpy(&OutHeader, Data.GetData(), sizeof(OutHeader));
+
+	if (!OutHeader.Matches(FAIJournalHeader())) return false;
+
+	FAIGenerationDelta Delta;
+	int64 Cursor = sizeof(FAIJournalHeader);
+
+	while (Cursor + (int64)sizeof(FAIJournalRecordHeader) <= Data.Num())
+	{
+		FAIJournalRecordHeader Record;
+		FMemory::Memcpy(&Record, Data.GetData() + Cursor, sizeof(Record));
+		Cursor += sizeof(Record);
+
+		// A crash while appending leaves a torn last record
+		if (Cursor + Record.Size > Data.Num() || FCrc::MemCrc32(Data.GetData() + Cursor, Record.Size) != Record.Crc)
+			break;
+
+		FBitReader Reader(Data.GetData() + Cursor, Record.Size * 8);
+		Cursor += Record.Size;
+
+		if (!Decode(Reader, Delta)) break;
+
+		Visit(Delta);
+	}
+
+	return true;
+}
+
+void FAIJournal::Encode(const FAIGenerationDelta& Delta, FBitWriter& Writer)
+{
+	uint32 Generation = Delta.Generation;
+	uint32 Num = Delta.Survived.Num();
+
+	Writer.SerializeIntPacked(Generation);
+	Writer.SerializeIntPacked(Num);
+
+	// Deaths
+	TArray<uint32> SurvivorRank;
+	SurvivorRank.SetNumUninitialized(Num);
+	uint32 Survivors = 0;
+
+	for (uint32 i = 0; i < Num; i++)
+	{
+		Writer.WriteBit(Delta.Survived[i]);
+		SurvivorRank[i] = Survivors;
+		Survivors += Delta.Survived[i];
+	}
+
+	// Births, parents are always survivors so only their rank among the survivors is stored
+	for (uint32 i = 0; i < Num; i++)
+	{
+		if (Survivors == 0)
+		{
+			uint32 RandomNum = Delta.RandomNum[i];
+			Writer.SerializeIntPacked(RandomNum);
+			continue;
+		}
+
+		uint32 Rank = SurvivorRank[Delta.ParentOf[i]];
+		Writer.SerializeInt(Rank, Survivors);
+
+		// Mates are survivors too
+		const FAICrossover& Crossover = Delta.Crossovers[i];
+		Writer.WriteBit(Crossover.Mate != INDEX_NONE);
+
+		if (Crossover.Mate == INDEX_NONE) continue;
+
+		uint32 MateRank = SurvivorRank[Crossover.Mate];
+		uint32 Start = Crossover.Start;
+		uint32 Length = Crossover.End - Crossover.Start;
+
+		Writer.SerializeInt(MateRank, Survivors);
+		Writer.SerializeIntPacked(Start);
+		Writer.SerializeIntPacked(Length);
+	}
+
+	for (FAIGene Gene : Delta.RandomGenes)
+	{
+		uint32 Word = Gene.ToWord();
+		Writer << Word;
+	}
+
+	// Mutations
+	for (uint32 i = 0; i < Num; i++)
+	{
+		uint32 EditNum = Delta.EditStart[i + 1] - Delta.EditStart[i];
+		Writer.SerializeIntPacked(EditNum);
+
+		for (int32 Edit = Delta.EditStart[i]; Edit < Delta.EditStart[i + 1]; Edit++)
+		{
+			const FAIGenomeEdit& GenomeEdit = Delta.Edits[Edit];
+			uint32 Packed = (uint32)GenomeEdit.Position << 2 | (uint32)GenomeEdit.Kind;
+			Writer.SerializeIntPacked(Packed);
+
+			if (GenomeEdit.Kind == EAIGenomeEdit::Insert)
+			{
+				uint32 Word = GenomeEdit.Word;
+				Writer << Word;
+			}
+		}
+	}
+}
+
+bool FAIJournal::Decode(FBitReader& Reader, FAIGenerationDelta& OutDelta)
+{
+	uint32 Num = 0;
+
+	Reader.SerializeIntPacked(OutDelta.Generation);
+	Reader.SerializeIntPacked(Num);
+
+	if (Reader.IsError() || Num > (uint32)Reader.GetBitsLeft()) return false;
+
+	OutDelta.Survived.SetNumUninitialized(Num);
+	OutDelta.ParentOf.SetNumUninitialized(Num);
+	OutDelta.Crossovers.Init(FAICrossover(), Num);
+	OutDelta.EditStart.SetNumUninitialized(Num + 1);
+	OutDelta.Edits.Reset();
+	OutDelta.RandomNum.Reset();
+	OutDelta.RandomGenes.Reset();
+
+	TArray<int32> Survivors;
+
+	for (uint32 i = 0; i < Num; i++)
+	{
+		OutDelta.Survived[i] = Reader.ReadBit() != 0;
+		if (OutDelta.Survived[i]) Survivors.Add(i);
+	}
+
+	int32 RandomGeneNum = 0;
+
+	for (uint32 i = 0; i < Num; i++)
+	{
+		if (Survivors.IsEmpty())
+		{
+			uint32 RandomNum = 0;
+			Reader.SerializeIntPacked(RandomNum);
+
+			if (RandomNum > (uint32)MAX_int32 - RandomGeneNum) return false;
+
+			OutDelta.ParentOf[i] = INDEX_NONE;
+			OutDelta.RandomNum.Add(RandomNum);
+			RandomGeneNum += RandomNum;
+			continue;
+		}
+
+		uint32 Rank = 0;
+		Reader.SerializeInt(Rank, Survivors.Num());
+		OutDelta.ParentOf[i] = Survivors[FMath::Min<int32>(Rank, Survivors.Num() - 1)];
+
+		if (!Reader.ReadBit()) continue;
+
+		uint32 MateRank = 0, Start = 0, Length = 0;
+		Reader.SerializeInt(MateRank, Survivors.Num());
+		Reader.SerializeIntPacked(Start);
+		Reader.SerializeIntPacked(Length);
+
+		if ((uint64)Start + Length > (uint64)MAX_int32) return false;
+
+		FAICrossover& Crossover = OutDelta.Crossovers[i];
+		Crossover.Mate = Survivors[FMath::Min<int32>(MateRank, Survivors.Num() - 1)];
+		Crossover.Start = Start;
+		Crossover.End = Start + Length;
+	}
+
+	if (Reader.IsError() || (int64)RandomGeneNum * 32 > Reader.GetBitsLeft()) return false;
+
+	OutDelta.RandomGenes.SetNumUninitialized(RandomGeneNum);
+
+	for (FAIGene& Gene : OutDelta.RandomGenes)
+	{
+		uint32 Word = 0;
+		Reader << Word;
+		Gene = FAIGene::FromWord(Word);
+	}
+
+	for (uint32 i = 0; i < Num; i++)
+	{
+		uint32 EditNum = 0;
+		Reader.SerializeIntPacked(EditNum);
+
+		OutDelta.EditStart[i] = OutDelta.Edits.Num();
+
+		if (Reader.IsError() || EditNum > (uint32)Reader.GetBitsLeft()) return false;
+
+		bool bInserted = false;
+
+		for (uint32 Edit = 0; Edit < EditNum; Edit++)
+		{
+			uint32 Packed = 0;
+			Reader.SerializeIntPacked(Packed);
+
+			FAIGenomeEdit& GenomeEdit = OutDelta.Edits.AddDefaulted_GetRef();
+			GenomeEdit.Kind = (EAIGenomeEdit)(Packed & 3);
+			GenomeEdit.Position = Packed >> 2;
+			GenomeEdit.Word = 0;
+
+			// A mutation inserts at most one gene, positions are checked against the genomes on replay
+			if (GenomeEdit.Kind > EAIGenomeEdit::Delete) return false;
+
+			if (GenomeEdit.Kind == EAIGenomeEdit::Insert)
+			{
+				if (bInserted) return false;
+
+				bInserted = true;
+				Reader << GenomeEdit.Word;
+			}
+		}
+	}
+
+	OutDelta.EditStart[Num] = OutDelta.Edits.Num();
+
+	return !Reader.IsError();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIGeneration.h"
+#include "AIFileFormat.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+class FBitWriter;
+class FBitReader;
+
+/** Start of a journal, ties it to the snapshot it continues from */
+struct FAIJournalHeader : FAIFileHeader
+{
+	static constexpr uint32 MagicValue = 0x524A4941; // "AIJR"
+
+	static constexpr uint32 VersionValue = 2;
+
+	FAIJournalHeader() : FAIFileHeader{MagicValue, VersionValue} {}
+
+	uint32 RunSeed = 0;
+
+	/** Generation of the snapshot the journal continues from */
+	uint32 BaseGeneration = 0;
+};
+
+/** Append-only log of every turnover since the last full snapshot, bit packed and checksummed */
+class FAIJournal
+{
+public:
+	~FAIJournal() { Close(); }
+
+	/**
+	 * Start a new journal, replacing the file
+	 *
+	 * @param Path File to write
+	 * @param RunSeed Seed of the run
+	 * @param BaseGeneration Generation of the snapshot the journal continues from
+	 * @return If the file could be opened
+	 */
+	bool Open(const FString& Path, uint32 RunSeed, uint32 BaseGeneration);
+
+	void Close();
+
+	bool IsOpen() const { return FileHandle.IsValid(); }
+
+	/** Append a turnover and flush it to disk */
+	void Append(const FAIGenerationDelta& Delta);
+
+	/**
+	 * Read every complete record of a journal, stops at the first torn or corrupted record
+	 *
+	 * @param Path File to read
+	 * @param OutHeader Header of the journal
+	 * @param Visit Called with every record in order
+	 * @return If the journal header could be read
+	 */
+	static bool Read(const FString& Path, FAIJournalHeader& OutHeader,
+	                 TFunctionRef<void(const FAIGenerationDelta&)> Visit);
+
+private:
+	TUniquePtr<IFileHandle> FileHandle;
+
+	static void Encode(const FAIGenerationDelta& Delta, FBitWriter& Writer);
+
+	static bool Decode(FBitReader& Reader, FAIGenerationDelta& OutDelta);
+};
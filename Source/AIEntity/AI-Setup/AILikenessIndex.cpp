@@ -0,0 +1,78 @@
+#include "AILikenessIndex.h"
+#include "Algo/Sort.h"
+
+void FAILocationTree::Build(const TArray<FVector>& Locations)
+{
+	Points.Reset(Locations.Num());
+	for (const FVector& Location : Locations) Points.Add(FVector2D(Location));
+
+	BuildRange(0, Points.Num(), 0);
+}
+
+void FAILocationTree::BuildRange(int32 Lo, int32 Hi, int32 Depth)
+{
+	if (Hi - Lo <= 1) return;
+
+	const int32 Axis = Depth % 2;
+
+	// Sorting the range leaves its median in the middle, both halves are built the same way
+	Algo::Sort(TArrayView<FVector2D>(Points.GetData() + Lo, Hi - Lo), [Axis](const FVector2D& A, const FVector2D& B)
+	{
+		return A[Axis] < B[Axis];
+	});
+
+	const int32 Mid = Lo + (Hi - Lo) / 2;
+
+	BuildRange(Lo, Mid, Depth + 1);
+	BuildRange(Mid + 1, Hi, Depth + 1);
+}
+
+bool FAILocationTree::FindNearest(const FVector& Location, float MaxDistance, FVector2D& OutNearest) const
+{
+	float BestDistanceSq = FMath::Square(MaxDistance);
+	int32 Best = INDEX_NONE;
+
+	SearchRange(0, Points.Num(), 0, FVector2D(Location), BestDistanceSq, Best);
+
+	if (Best == INDEX_NONE) return false;
+
+	OutNearest = Points[Best];
+	return true;
+}
+
+void FAILocationTree::SearchRange(int32 Lo, int32 Hi, int32 Depth, const FVector2D& Target, float& BestDistanceSq,
+                                  int32& Best) const
+{
+	if (Lo >= Hi) return;
+
+	const int32 Mid = Lo + (Hi - Lo) / 2;
+	const int32 Axis = Depth % 2;
+
+	const float DistanceSq = FVector2D::DistSquared(Target, Points[Mid]);
+	if (DistanceSq < BestDistanceSq)
+	{
+		BestDistanceSq = DistanceSq;
+		Best = Mid;
+	}
+
+	const float Delta = Target[Axis] - Points[Mid][Axis];
+
+	// Near side first, the far side only if the splitting line is closer than the best so far
+	if (Delta < 0)
+	{
+		SearchRange(Lo, Mid, Depth + 1, Target, BestDistanceSq, Best);
+		if (FMath::Square(Delta) < BestDistanceSq) SearchRange(Mid + 1, Hi, Depth + 1, Target, BestDistanceSq, Best);
+	}
+	else
+	{
+		SearchRange(Mid + 1, Hi, Depth + 1, Target, BestDistanceSq, Best);
+		if (FMath::Square(Delta) < BestDistanceSq) SearchRange(Lo, Mid, Depth + 1, Target, BestDistanceSq, Best);
+	}
+}
+
+void FAILikenessIndex::Build(const FAILikenessLocations& Locations)
+{
+	Trees[(uint8)EAIEntityState::Interested].Build(Locations.InterestedLocations);
+	Trees[(uint8)EAIEntityState::Neutral].Build(Locations.NeutralLocations);
+	Trees[(uint8)EAIEntityState::Wary].Build(Locations.WaryLocations);
+}
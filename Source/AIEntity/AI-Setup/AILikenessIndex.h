@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+
+/**
+ * Static 2D k-d tree over a set of locations, stored implicitly: each range of the point array is
+ * split at its median, alternating between the X and Y axis with depth.
+ */
+class FAILocationTree
+{
+public:
+	/** Build the tree over a set of locations, height is ignored */
+	void Build(const TArray<FVector>& Locations);
+
+	/**
+	 * Find the nearest location
+	 *
+	 * @param Location Where to search from
+	 * @param MaxDistance Locations further away are ignored
+	 * @param OutNearest Nearest location found
+	 * @return If a location in range was found
+	 */
+	bool FindNearest(const FVector& Location, float MaxDistance, FVector2D& OutNearest) const;
+
+	int32 Num() const { return Points.Num(); }
+
+private:
+	TArray<FVector2D> Points;
+
+	/** Order the points from Lo to one before Hi around their median */
+	void BuildRange(int32 Lo, int32 Hi, int32 Depth);
+
+	/** Search the points from Lo to one before Hi for one nearer than Best */
+	void SearchRange(int32 Lo, int32 Hi, int32 Depth, const FVector2D& Target, float& BestDistanceSq,
+	                 int32& Best) const;
+};
+
+/**
+ * Index of the likeness locations of the population, one tree per entity state so nearest
+ * interested or wary targets are found in O(log n)
+ */
+class FAILikenessIndex
+{
+public:
+	/** Build the trees over the likeness locations */
+	void Build(const FAILikenessLocations& Locations);
+
+	/** Tree of a state */
+	const FAILocationTree& GetTree(EAIEntityState State) const { return Trees[(uint8)State]; }
+
+private:
+	FAILocationTree Trees[3];
+};
@@ -0,0 +1,100 @@
+#include "AILikenessRegistry.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Blueprint/BlueprintSupport.h"
+#include "Engine/Blueprint.h"
+
+/** Generated class of a blueprint asset, which unlike the blueprint is also cooked, or the path itself */
+static FSoftObjectPath LoadablePath(const FSoftObjectPath& Path)
+{
+	IAssetRegistry* AssetRegistry = IAssetRegistry::Get();
+	FAssetData AssetData;
+	FString GeneratedClass;
+
+	if (AssetRegistry &&
+		AssetRegistry->TryGetAssetByObjectPath(Path, AssetData) == UE::AssetRegistry::EExists::Exists &&
+		AssetData.GetTagValue(FBlueprintTags::GeneratedClassPath, GeneratedClass))
+		return FSoftObjectPath(FPackageName::ExportTextPathToObjectPath(GeneratedClass));
+
+	return Path;
+}
+
+void FAILikenessRegistry::Register(const FAILikenessObjects& Objects, TArray<FSoftObjectPath>& OutNewPaths)
+{
+	const TArray<TSoftObjectPtr<UObject>>* Lists[3] = {
+		&Objects.InterestedObjects,
+		&Objects.NeutralObjects,
+		&Objects.WaryObjects
+	};
+
+	for (uint8 State = 0; State < 3; State++)
+	{
+		for (const TSoftObjectPtr<UObject>& Object : *Lists[State])
+		{
+			if (Object.IsNull()) continue;
+
+			const FSoftObjectPath Path = LoadablePath(Object.ToSoftObjectPath());
+
+			if (Path.IsNull() || Requested.Contains(Path)) continue;
+
+			Requested.Add(Path, (EAIEntityState)State);
+			OutNewPaths.Add(Path);
+		}
+	}
+}
+
+void FAILikenessRegistry::Resolve(const TArray<FSoftObjectPath>& Paths,
+                                  TArray<TPair<AActor*, EAIEntityState>>& OutActors)
+{
+	for (const FSoftObjectPath& Path : Paths)
+	{
+		UObject* Object = Path.ResolveObject();
+		const EAIEntityState* State = Requested.Find(Path);
+
+		if (!Object || !State) continue;
+
+#if WITH_EDITORONLY_DATA
+		// Blueprints the asset registry did not know of yet, every actor spawned from them is classified
+		if (const UBlueprint* Blueprint = Cast<UBlueprint>(Object))
+			Object = Blueprint->GeneratedClass;
+#endif
+
+		States.Add(TObjectKey<UObject>(Object), *State);
+
+		if (AActor* Actor = Cast<AActor>(Object)) OutActors.Add({Actor, *State});
+	}
+
+	// Classes classified before may inherit from one of the new ones
+	ClassStates.Reset();
+}
+
+bool FAILikenessRegistry::Classify(const AActor* Actor, EAIEntityState& OutState) const
+{
+	if (!Actor) return false;
+
+	if (const EAIEntityState* State = States.Find(TObjectKey<UObject>(Actor)))
+	{
+		OutState = *State;
+		return true;
+	}
+
+	UClass* ActorClass = Actor->GetClass();
+	TOptional<EAIEntityState>* ClassState = ClassStates.Find(ActorClass);
+
+	// The nearest listed class up the hierarchy wins, only walked once per class
+	if (!ClassState)
+	{
+		TOptional<EAIEntityState> Inherited;
+
+		for (const UClass* Class = ActorClass; Class && !Inherited.IsSet(); Class = Class->GetSuperClass())
+		{
+			if (const EAIEntityState* State = States.Find(TObjectKey<UObject>(Class))) Inherited = *State;
+		}
+
+		ClassState = &ClassStates.Add(ActorClass, Inherited);
+	}
+
+	if (!ClassState->IsSet()) return false;
+
+	OutState = ClassState->GetValue();
+	return true;
+}
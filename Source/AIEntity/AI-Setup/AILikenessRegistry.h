@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "AIDataTypes.h"
+
+/**
+ * Likeness objects of the population resolved to their state once loaded. A listed class also
+ * classifies every subclass of it.
+ */
+class FAILikenessRegistry
+{
+public:
+	/**
+	 * Collect the soft references of a likeness that were not requested yet
+	 *
+	 * @param Objects Likeness objects of an entity
+	 * @param OutNewPaths Paths to load, first state registered for a path wins
+	 */
+	void Register(const FAILikenessObjects& Objects, TArray<FSoftObjectPath>& OutNewPaths);
+
+	/**
+	 * Map loaded objects to the state they were requested with
+	 *
+	 * @param Paths Paths that finished loading
+	 * @param OutActors Resolved objects placed in the world
+	 */
+	void Resolve(const TArray<FSoftObjectPath>& Paths, TArray<TPair<AActor*, EAIEntityState>>& OutActors);
+
+	/**
+	 * State of an actor, either listed itself or through its class or a parent class, game thread only
+	 *
+	 * @param Actor Actor to classify
+	 * @param OutState State of the actor
+	 * @return If the actor is a likeness object
+	 */
+	bool Classify(const AActor* Actor, EAIEntityState& OutState) const;
+
+private:
+	/** Every path requested and the state it was requested with */
+	TMap<FSoftObjectPath, EAIEntityState> Requested;
+
+	/** Resolved objects or classes and their state */
+	TMap<TObjectKey<UObject>, EAIEntityState> States;
+
+	/** State every class classified so far inherits, unset if none, cleared whenever objects resolve */
+	mutable TMap<TObjectKey<UClass>, TOptional<EAIEntityState>> ClassStates;
+};
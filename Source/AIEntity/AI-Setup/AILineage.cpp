@@ -0,0 +1,337 @@
+#include "AILineage.h"
+#include "../AIEntity.h"
+#include "AIGenomeKernels.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+/** Start of a lineage index, followed by the record offset of every generation in order */
+struct FAILineageIndexHeader : FAIFileHeader
+{
+	static constexpr uint32 MagicValue = 0x584C4941; // "AILX"
+
+	FAILineageIndexHeader() : FAIFileHeader{MagicValue, FAILineageHeader::VersionValue} {}
+
+	uint32 RunSeed = 0;
+
+	/** Generation of the first offset */
+	uint32 FirstGeneration = 0;
+};
+
+/**
+ * Read the index of a lineage
+ *
+ * @param Path Index file
+ * @param OutHeader Header of the index
+ * @param OutOffsets Record offset of every generation from the first one
+ * @return If the index is of the current version
+ */
+static bool ReadLineageIndex(const FString& Path, FAILineageIndexHeader& OutHeader, TArray<int64>& OutOffsets)
+{
+	TArray<uint8> Index;
+
+	if (!FFileHelper::LoadFileToArray(Index, *Path, FILEREAD_Silent) ||
+		Index.Num() < (int32)sizeof(FAILineageIndexHeader))
+		return false;
+
+	FMemory::Memcpy(&OutHeader, Index.GetData(), sizeof(OutHeader));
+
+	if (!OutHeader.Matches(FAILineageIndexHeader())) return false;
+
+	const int32 Num = (Index.Num() - sizeof(FAILineageIndexHeader)) / sizeof(int64);
+	OutOffsets.SetNumUninitialized(Num);
+	FMemory::Memcpy(OutOffsets.GetData(), Index.GetData() + sizeof(FAILineageIndexHeader), Num * sizeof(int64));
+
+	return true;
+}
+
+FString FAILineageStore::LineagePath(const FString& Directory)
+{
+	return Directory / TEXT("Lineage.ailn");
+}
+
+FString FAILineageStore::IndexPath(const FString& Directory)
+{
+	return Directory / TEXT("Lineage.ailx");
+}
+
+bool FAILineageStore::Open(const FString& Directory, uint32 RunSeed, uint32 Generation, int32 InAnchorInterval,
+                           TArrayView<const TArrayView<const FAIGene>> Genomes)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*Directory);
+
+	const FString Path = LineagePath(Directory);
+	AnchorInterval = FMath::Max(1, InAnchorInterval);
+
+	// A lineage of the same run is continued. Generations it recorded from this one on were left behind by
+	// a load and are dropped from the index, generations it missed are indexed as absent
+	FAILineageIndexHeader IndexHeader;
+	TArray<int64> Offsets;
+	FAILineageHeader Header;
+
+	bool bContinue = ReadLineageIndex(IndexPath(Directory), IndexHeader, Offsets) &&
+		IndexHeader.RunSeed == RunSeed && IndexHeader.FirstGeneration <= Generation;
+
+	if (bContinue)
+	{
+		const TUniquePtr<IFileHandle> Existing(PlatformFile.OpenRead(*Path));
+
+		bContinue = Existing && Existing->Read((uint8*)&Header, sizeof(Header)) &&
+			Header.Matches(FAILineageHeader()) && Header.SensorNum == AISensoryCount &&
+			Header.ActionNum == AIActionsCount && Header.RunSeed == RunSeed;
+	}
+
+	if (bContinue)
+	{
+		const int32 Kept = Generation - IndexHeader.FirstGeneration;
+
+		if (Offsets.Num() > Kept) Offsets.SetNum(Kept);
+		while (Offsets.Num() < Kept) Offsets.Add(INDEX_NONE);
+
+		FileHandle.Reset(PlatformFile.OpenWrite(*Path, true));
+	}
+	else
+	{
+		Offsets.Reset();
+
+		IndexHeader = FAILineageIndexHeader();
+		IndexHeader.RunSeed = RunSeed;
+		IndexHeader.FirstGeneration = Generation;
+
+		FileHandle.Reset(PlatformFile.OpenWrite(*Path));
+	}
+
+	// The index is small enough to rewrite whole
+	IndexHandle.Reset(PlatformFile.OpenWrite(*IndexPath(Directory)));
+
+	if (!FileHandle || !IndexHandle)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Could not open lineage in %s"), *Directory);
+		Close();
+		return false;
+	}
+
+	if (bContinue) FileHandle->SeekFromEnd(0);
+	else
+	{
+		Header = FAILineageHeader();
+		Header.RunSeed = RunSeed;
+		Header.AnchorInterval = AnchorInterval;
+		FileHandle->Write((const uint8*)&Header, sizeof(Header));
+	}
+
+	IndexHandle->Write((const uint8*)&IndexHeader, sizeof(IndexHeader));
+	IndexHandle->Write((const uint8*)Offsets.GetData(), Offsets.Num() * sizeof(int64));
+
+	// Parents of the first generation are not known
+	TArray<int32> Parents;
+	Parents.Init(INDEX_NONE, Genomes.Num());
+
+	Write(Generation, true, Parents, nullptr, Genomes);
+
+	return true;
+}
+
+void FAILineageStore::Close()
+{
+	FileHandle.Reset();
+	IndexHandle.Reset();
+}
+
+void FAILineageStore::Append(const FAIGenerationDelta& Delta, TArrayView<const TArrayView<const FAIGene>> Genomes)
+{
+	if (!FileHandle) return;
+
+	Write(Delta.Generation, Delta.Generation % AnchorInterval == 0, Delta.ParentOf, &Delta, Genomes);
+}
+
+void FAILineageStore::Write(uint32 Generation, bool bAnchor, TArrayView<const int32> Parents,
+                            const FAIGenerationDelta* Delta, TArrayView<const TArrayView<const FAIGene>> Genomes)
+{
+	const int32 Num = Parents.Num();
+	check(Genomes.Num() == Num);
+
+	FAILineageRecord Record = {Generation, Num, Delta ? Delta->Edits.Num() : 0, 0, bAnchor};
+
+	// Only genomes that can not be rebuilt from a parent alone are stored
+	auto Mate = [Delta](int32 i) { return Delta ? Delta->Crossovers[i].Mate : INDEX_NONE; };
+	auto Stored = [&](int32 i) { return bAnchor || Parents[i] == INDEX_NONE || Mate(i) != INDEX_NONE; };
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (Stored(i)) Record.GeneNum += Genomes[i].Num();
+	}
+
+	const int64 RecordSize = sizeof(FAILineageRecord) + (Num * 4 + 2) * sizeof(int32) +
+		Record.EditNum * sizeof(FAILineageEdit) + Record.GeneNum * sizeof(FAIGene);
+
+	Buffer.SetNumUninitialized(RecordSize, EAllowShrinking::No);
+	uint8* Cursor = Buffer.GetData();
+
+	auto Take = [&Cursor](SIZE_T Bytes)
+	{
+		uint8* Section = Cursor;
+		Cursor += Bytes;
+		return Section;
+	};
+
+	FMemory::Memcpy(Take(sizeof(Record)), &Record, sizeof(Record));
+	FMemory::Memcpy(Take(Num * sizeof(int32)), Parents.GetData(), Num * sizeof(int32));
+
+	int32* Mates = (int32*)Take(Num * sizeof(int32));
+	for (int32 i = 0; i < Num; i++) Mates[i] = Mate(i);
+
+	int32* EditStart = (int32*)Take((Num + 1) * sizeof(int32));
+	int32* GeneStart = (int32*)Take((Num + 1) * sizeof(int32));
+
+	if (Delta) FMemory::Memcpy(EditStart, Delta->EditStart.GetData(), (Num + 1) * sizeof(int32));
+	else FMemory::Memzero(EditStart, (Num + 1) * sizeof(int32));
+
+	FAILineageEdit* Edits = (FAILineageEdit*)Take(Record.EditNum * sizeof(FAILineageEdit));
+
+	for (int32 i = 0; i < Record.EditNum; i++)
+	{
+		const FAIGenomeEdit& Edit = Delta->Edits[i];
+		Edits[i] = {((uint32)Edit.Kind << 30) | (uint32)Edit.Position, Edit.Word};
+	}
+
+	FAIGene* Genes = (FAIGene*)Cursor;
+	GeneStart[0] = 0;
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		const int32 Length = Stored(i) ? Genomes[i].Num() : 0;
+
+		FMemory::Memcpy(Genes + GeneStart[i], Genomes[i].GetData(), Length * sizeof(FAIGene));
+		GeneStart[i + 1] = GeneStart[i] + Length;
+	}
+
+	const int64 Offset = FileHandle->Tell();
+
+	FileHandle->Write(Buffer.GetData(), RecordSize);
+	FileHandle->Flush();
+
+	// Indexed only once the record is on disk
+	IndexHandle->Write((const uint8*)&Offset, sizeof(Offset));
+	IndexHandle->Flush();
+}
+
+bool FAILineageReader::Open(const FString& Directory)
+{
+	FAILineageIndexHeader IndexHeader;
+
+	if (!ReadLineageIndex(FAILineageStore::IndexPath(Directory), IndexHeader, Offsets)) return false;
+
+	if (!File.Open(FAILineageStore::LineagePath(Directory))) return false;
+
+	const FAILineageHeader* Header = File.GetHeader<FAILineageHeader>();
+
+	if (!Header || Header->SensorNum != AISensoryCount || Header->ActionNum != AIActionsCount ||
+		Header->RunSeed != IndexHeader.RunSeed)
+		return false;
+
+	FirstGeneration = IndexHeader.FirstGeneration;
+
+	return Offsets.Num() > 0;
+}
+
+bool FAILineageReader::View(uint32 Generation, FRecordView& OutView) const
+{
+	if (Generation < FirstGeneration || Generation - FirstGeneration >= (uint32)Offsets.Num()) return false;
+
+	const int64 Offset = Offsets[Generation - FirstGeneration];
+
+	if (Offset < 0 || Offset + (int64)sizeof(FAILineageRecord) > File.GetSize()) return false;
+
+	const FAILineageRecord* Record = (const FAILineageRecord*)(File.GetData() + Offset);
+	const int32 Num = Record->EntityNum;
+
+	if (Record->Generation != Generation || Num < 0 || Record->EditNum < 0 || Record->GeneNum < 0) return false;
+
+	const int64 RecordSize = sizeof(FAILineageRecord) + ((int64)Num * 4 + 2) * sizeof(int32) +
+		(int64)Record->EditNum * sizeof(FAILineageEdit) + (int64)Record->GeneNum * sizeof(FAIGene);
+
+	if (Offset + RecordSize > File.GetSize()) return false;
+
+	OutView.Record = Record;
+	OutView.Parents = (const int32*)(Record + 1);
+	OutView.Mates = OutView.Parents + Num;
+	OutView.EditStart = OutView.Mates + Num;
+	OutView.GeneStart = OutView.EditStart + Num + 1;
+	OutView.Edits = (const FAILineageEdit*)(OutView.GeneStart + Num + 1);
+	OutView.Genes = (const FAIGene*)(OutView.Edits + Record->EditNum);
+
+	return true;
+}
+
+bool FAILineageReader::Ancestors(FAILineageId Id, TArray<FAILineageId>& OutAncestors) const
+{
+	OutAncestors.Reset();
+
+	FRecordView View;
+
+	if (!this->View(Id.Generation, View) || Id.Entity < 0 || Id.Entity >= View.Record->EntityNum) return false;
+
+	while (View.Parents[Id.Entity] != INDEX_NONE)
+	{
+		Id = {Id.Generation - 1, View.Parents[Id.Entity]};
+
+		if (!this->View(Id.Generation, View) || Id.Entity >= View.Record->EntityNum) break;
+
+		OutAncestors.Add(Id);
+	}
+
+	return true;
+}
+
+bool FAILineageReader::Reconstruct(FAILineageId Id, TArray<FAIGene>& OutGenome) const
+{
+	// Walk back to the closest stored genome
+	TArray<TPair<FRecordView, int32>, TInlineAllocator<64>> Chain;
+	FRecordView View;
+
+	for (;;)
+	{
+		if (!this->View(Id.Generation, View) || Id.Entity < 0 || Id.Entity >= View.Record->EntityNum) return false;
+
+		if (View.Record->bAnchor || View.Parents[Id.Entity] == INDEX_NONE || View.Mates[Id.Entity] != INDEX_NONE)
+			break;
+
+		Chain.Add({View, Id.Entity});
+		Id = {Id.Generation - 1, View.Parents[Id.Entity]};
+	}
+
+	const int32 GeneStart = View.GeneStart[Id.Entity];
+	OutGenome = TArrayView<const FAIGene>(View.Genes + GeneStart, View.GeneStart[Id.Entity + 1] - GeneStart);
+
+	// Redo the mutations from the oldest one
+	TArray<FAIGenomeEdit, TInlineAllocator<64>> Edits;
+
+	for (int32 Link = Chain.Num() - 1; Link >= 0; Link--)
+	{
+		const FRecordView& Child = Chain[Link].Key;
+		const int32 Entity = Chain[Link].Value;
+
+		Edits.Reset();
+
+		if (Child.EditStart[Entity] < 0 || Child.EditStart[Entity + 1] > Child.Record->EditNum) return false;
+
+		for (int32 Edit = Child.EditStart[Entity]; Edit < Child.EditStart[Entity + 1]; Edit++)
+		{
+			const FAILineageEdit& Stored = Child.Edits[Edit];
+			Edits.Add({(EAIGenomeEdit)(Stored.KindPosition >> 30), (int32)(Stored.KindPosition & 0x3FFFFFFF),
+			           Stored.Word});
+		}
+
+		// Room for every insertion
+		int32 Num = OutGenome.Num();
+		OutGenome.AddUninitialized(Edits.Num());
+
+		FAIGenomeKernels::ApplyEdits(OutGenome.GetData(), Num, Edits);
+		OutGenome.SetNum(Num, EAllowShrinking::No);
+	}
+
+	return true;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIGeneration.h"
+#include "AIFileFormat.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+/** Start of a lineage file */
+struct FAILineageHeader : FAIFileHeader
+{
+	static constexpr uint32 MagicValue = 0x4E4C4941; // "AILN"
+
+	static constexpr uint32 VersionValue = 3;
+
+	FAILineageHeader() : FAIFileHeader{MagicValue, VersionValue} {}
+
+	/** Sensor and action counts the stored genes address */
+	uint32 SensorNum = AISensoryCount;
+	uint32 ActionNum = AIActionsCount;
+
+	uint32 RunSeed = 0;
+
+	/** Generations between anchors storing every genome in full */
+	int32 AnchorInterval = 0;
+};
+
+/**
+ * Start of the record of one generation, followed by the parent and the mate of every entity, the
+ * first edit and first stored gene of every entity with one extra element closing the last entity,
+ * the edits and the stored genes. Every array is made of 4-byte values so the record is read in place.
+ */
+struct FAILineageRecord
+{
+	uint32 Generation;
+
+	int32 EntityNum;
+
+	int32 EditNum;
+
+	int32 GeneNum;
+
+	/** Every genome of the generation is stored in full */
+	uint32 bAnchor;
+};
+
+/** Edit of a child genome as stored in a lineage record */
+struct FAILineageEdit
+{
+	/** Kind in the top two bits, position in the rest */
+	uint32 KindPosition;
+
+	uint32 Word;
+};
+
+/** Entity of a generation in a lineage */
+struct FAILineageId
+{
+	uint32 Generation;
+
+	int32 Entity;
+};
+
+/**
+ * Append-only store of who descends from whom. Children are stored as the edits of their mutation,
+ * only genomes without a parent, children of a crossover and periodic anchors are stored in full.
+ */
+class FAILineageStore
+{
+public:
+	~FAILineageStore() { Close(); }
+
+	/** Lineage file of a run, the index sits next to it */
+	static FString LineagePath(const FString& Directory);
+
+	static FString IndexPath(const FString& Directory);
+
+	/**
+	 * Continue the lineage of the run, or start one, with an anchor of the current generation. Records
+	 * the lineage holds from the current generation on are dropped.
+	 *
+	 * @param Directory Directory of the run
+	 * @param RunSeed Seed of the run
+	 * @param Generation Current generation
+	 * @param AnchorInterval Generations between anchors
+	 * @param Genomes Genome of every entity of the current generation
+	 * @return If the files could be opened
+	 */
+	bool Open(const FString& Directory, uint32 RunSeed, uint32 Generation, int32 AnchorInterval,
+	          TArrayView<const TArrayView<const FAIGene>> Genomes);
+
+	void Close();
+
+	bool IsOpen() const { return FileHandle.IsValid(); }
+
+	/**
+	 * Append a turnover and flush it to disk
+	 *
+	 * @param Delta Decisions of the turnover
+	 * @param Genomes Genome of every child, stored for anchors and children without a parent
+	 */
+	void Append(const FAIGenerationDelta& Delta, TArrayView<const TArrayView<const FAIGene>> Genomes);
+
+private:
+	TUniquePtr<IFileHandle> FileHandle;
+
+	TUniquePtr<IFileHandle> IndexHandle;
+
+	int32 AnchorInterval = 0;
+
+	TArray<uint8> Buffer;
+
+	void Write(uint32 Generation, bool bAnchor, TArrayView<const int32> Parents, const FAIGenerationDelta* Delta,
+	           TArrayView<const TArrayView<const FAIGene>> Genomes);
+};
+
+/** Maps a lineage and walks it backwards, rebuilding any genome from the closest stored ancestor */
+class FAILineageReader
+{
+public:
+	/** Map the lineage of the run in a directory and read its index */
+	bool Open(const FString& Directory);
+
+	/** First and last generation recorded */
+	uint32 GetFirstGeneration() const { return FirstGeneration; }
+
+	uint32 GetLastGeneration() const { return FirstGeneration + Offsets.Num() - 1; }
+
+	/**
+	 * Every ancestor of an entity up to the first recorded generation or a genome without a parent
+	 *
+	 * @param Id Entity to trace
+	 * @param OutAncestors Parent first, then its parent and so on
+	 * @return If the entity is recorded
+	 */
+	bool Ancestors(FAILineageId Id, TArray<FAILineageId>& OutAncestors) const;
+
+	/**
+	 * Rebuild the genome of an entity from its closest stored ancestor and the edits since
+	 *
+	 * @param Id Entity to rebuild
+	 * @param OutGenome Genes of the entity
+	 * @return If the entity is recorded
+	 */
+	bool Reconstruct(FAILineageId Id, TArray<FAIGene>& OutGenome) const;
+
+private:
+	struct FRecordView
+	{
+		const FAILineageRecord* Record = nullptr;
+		const int32* Parents = nullptr;
+		const int32* Mates = nullptr;
+		const int32* EditStart = nullptr;
+		const int32* GeneStart = nullptr;
+		const FAILineageEdit* Edits = nullptr;
+		const FAIGene* Genes = nullptr;
+	};
+
+	FAIFileView File;
+
+	uint32 FirstGeneration = 0;
+
+	/** Offset of the record of every generation from the first one */
+	TArray<int64> Offsets;
+
+	bool View(uint32 Generation, FRecordView& OutView) const;
+};
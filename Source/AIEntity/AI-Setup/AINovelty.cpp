@@ -0,0 +1,276 @@
+#include "AINovelty.h"
+#include "../AIEntity.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+
+DECLARE_CYCLE_STAT(TEXT("Novelty Score"), STAT_AINoveltyScore, STATGROUP_AIEntity);
+
+/** Ranges at least this large build their halves in parallel */
+static constexpr int32 ParallelBuildSize = 4096;
+
+/** Keep a distance if it is among the K smallest seen */
+static void OfferNeighbor(FAINeighborHeap& Heap, int32 K, float Distance)
+{
+	if (Heap.Num() < K)
+	{
+		Heap.HeapPush(Distance, TGreater<float>());
+		return;
+	}
+
+	if (Distance >= Heap.HeapTop()) return;
+
+	Heap.HeapPopDiscard(TGreater<float>(), EAllowShrinking::No);
+	Heap.HeapPush(Distance, TGreater<float>());
+}
+
+float FAIBehavior::Distance(const FAIBehavior& A, const FAIBehavior& B)
+{
+	float DistanceSq = 0.0f;
+	for (int32 i = 0; i < AIBehaviorSize; i++) DistanceSq += FMath::Square(A.Values[i] - B.Values[i]);
+
+	return FMath::Sqrt(DistanceSq);
+}
+
+void FAIBehaviorAccumulator::Step(const FVector2D& Location, const FVector2D& KnownMin, const FVector2D& KnownMax)
+{
+	const FVector2D Cell = (Location - KnownMin) / (KnownMax - KnownMin) * AIBehaviorCellNum;
+	const int32 X = FMath::Clamp(FMath::FloorToInt32(Cell.X), 0, AIBehaviorCellNum - 1);
+	const int32 Y = FMath::Clamp(FMath::FloorToInt32(Cell.Y), 0, AIBehaviorCellNum - 1);
+
+	CellSteps[Y * AIBehaviorCellNum + X]++;
+	Steps++;
+}
+
+void FAIBehaviorAccumulator::Describe(const FVector2D& Location, const FVector2D& KnownMin,
+                                      const FVector2D& KnownMax, FAIBehavior& OutBehavior) const
+{
+	float* Values = OutBehavior.Values;
+	const FVector2D Relative = (Location - KnownMin) / (KnownMax - KnownMin);
+
+	*Values++ = FMath::Clamp(Relative.X, 0.0f, 1.0f);
+	*Values++ = FMath::Clamp(Relative.Y, 0.0f, 1.0f);
+
+	const float StepScale = Steps ? 1.0f / Steps : 0.0f;
+
+	for (const uint32 Count : CellSteps) *Values++ = Count * StepScale;
+	for (const uint32 Count : ActionSteps) *Values++ = Count * StepScale;
+}
+
+void FAIVantagePointTree::Build(TArray<FAIBehavior>&& InPoints)
+{
+	Points = MoveTemp(InPoints);
+
+	Order.SetNumUninitialized(Points.Num());
+	for (int32 i = 0; i < Points.Num(); i++) Order[i] = i;
+
+	Thresholds.SetNumUninitialized(Points.Num());
+	Distances.SetNumUninitialized(Points.Num());
+
+	Build(0, Points.Num());
+}
+
+void FAIVantagePointTree::Build(int32 Begin, int32 End)
+{
+	if (End - Begin <= 1)
+	{
+		if (End > Begin) Thresholds[Begin] = 0.0f;
+		return;
+	}
+
+	// Vantage point picked from the range itself so the build stays deterministic in parallel
+	Swap(Order[Begin], Order[Begin + (int32)(HashCombine(Begin, End) % (uint32)(End - Begin))]);
+
+	const FAIBehavior& Vantage = Points[Order[Begin]];
+
+	// Ranges own their points, so the distances of concurrent builds never overlap
+	for (int32 i = Begin + 1; i < End; i++) Distances[Order[i]] = FAIBehavior::Distance(Vantage, Points[Order[i]]);
+
+	const int32 Mid = Begin + 1 + (End - Begin - 1) / 2;
+
+	Algo::Sort(MakeArrayView(Order.GetData() + Begin + 1, End - Begin - 1), [this](int32 A, int32 B)
+	{
+		return Distances[A] < Distances[B];
+	});
+
+	Thresholds[Begin] = Distances[Order[Mid]];
+
+	if (End - Begin < ParallelBuildSize)
+	{
+		Build(Begin + 1, Mid);
+		Build(Mid, End);
+		return;
+	}
+
+	ParallelFor(2, [&](int32 Half)
+	{
+		if (Half == 0) Build(Begin + 1, Mid);
+		else Build(Mid, End);
+	});
+}
+
+void FAIVantagePointTree::Search(const FAIBehavior& Query, int32 K, int32 Ignore, int32 Checks,
+                                 FAINeighborHeap& Heap) const
+{
+	int32 ChecksLeft = Checks > 0 ? Checks : MAX_int32;
+
+	Search(0, Points.Num(), Query, K, Ignore, ChecksLeft, Heap);
+}
+
+void FAIVantagePointTree::Search(int32 Begin, int32 End, const FAIBehavior& Query, int32 K, int32 Ignore,
+                                 int32& Checks, FAINeighborHeap& Heap) const
+{
+	if (Begin >= End || Checks <= 0) return;
+
+	Checks--;
+
+	const int32 Id = Order[Begin];
+	const float Distance = FAIBehavior::Distance(Query, Points[Id]);
+
+	if (Id != Ignore) OfferNeighbor(Heap, K, Distance);
+
+	if (End - Begin == 1) return;
+
+	const int32 Mid = Begin + 1 + (End - Begin - 1) / 2;
+	const float Threshold = Thresholds[Begin];
+
+	// Furthest neighbor kept, a half further away than that from the query can not hold a closer one
+	auto Radius = [&Heap, K]() { return Heap.Num() < K ? TNumericLimits<float>::Max() : Heap.HeapTop(); };
+
+	if (Distance <= Threshold)
+	{
+		Search(Begin + 1, Mid, Query, K, Ignore, Checks, Heap);
+		if (Distance + Radius() >= Threshold) Search(Mid, End, Query, K, Ignore, Checks, Heap);
+	}
+	else
+	{
+		Search(Mid, End, Query, K, Ignore, Checks, Heap);
+		if (Distance - Radius() <= Threshold) Search(Begin + 1, Mid, Query, K, Ignore, Checks, Heap);
+	}
+}
+
+void FAIVantagePointTree::Reset()
+{
+	Points.Reset();
+	Order.Reset();
+	Thresholds.Reset();
+	Distances.Reset();
+}
+
+void FAINoveltyArchive::Add(const FAIBehavior& Behavior)
+{
+	Bucket.Add(Behavior);
+
+	if (Bucket.Num() < BucketSize) return;
+
+	// Carry the full bucket up like a binary counter, merging every occupied level on the way
+	TArray<FAIBehavior> Merged = MoveTemp(Bucket);
+	Bucket.Reset();
+
+	for (int32 Level = 0;; Level++)
+	{
+		if (Level == Levels.Num()) Levels.AddDefaulted();
+
+		if (Levels[Level].Num() == 0)
+		{
+			Levels[Level].Build(MoveTemp(Merged));
+			return;
+		}
+
+		Merged.Append(Levels[Level].GetPoints());
+		Levels[Level].Reset();
+	}
+}
+
+void FAINoveltyArchive::Score(TArrayView<const FAIBehavior> Population, int32 K, int32 MaxChecks,
+                              TArray<float>& OutNovelty)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AINoveltyScore);
+
+	const int32 Num = Population.Num();
+
+	PopulationTree.Build(TArray<FAIBehavior>(Population));
+	OutNovelty.SetNumUninitialized(Num);
+
+	// Every tree gets its share of the checks, and enough to reach a leaf and fill the neighbors
+	int64 TreeTotal = Num;
+	for (const FAIVantagePointTree& Level : Levels) TreeTotal += Level.Num();
+
+	auto TreeChecks = [&](const FAIVantagePointTree& Tree)
+	{
+		if (MaxChecks <= 0) return 0;
+
+		const int64 Share = (int64)MaxChecks * Tree.Num() / FMath::Max<int64>(TreeTotal, 1);
+
+		return (int32)FMath::Max<int64>(K + FMath::CeilLogTwo(Tree.Num() + 1), Share);
+	};
+
+	const int32 PopulationChecks = TreeChecks(PopulationTree);
+
+	TArray<int32, TInlineAllocator<32>> LevelChecks;
+	for (const FAIVantagePointTree& Level : Levels) LevelChecks.Add(TreeChecks(Level));
+
+	ParallelFor(Num, [&](int32 i)
+	{
+		FAINeighborHeap Heap;
+
+		PopulationTree.Search(Population[i], K, i, PopulationChecks, Heap);
+
+		for (int32 Level = 0; Level < Levels.Num(); Level++)
+			Levels[Level].Search(Population[i], K, INDEX_NONE, LevelChecks[Level], Heap);
+
+		for (const FAIBehavior& Behavior : Bucket)
+			OfferNeighbor(Heap, K, FAIBehavior::Distance(Population[i], Behavior));
+
+		float Sum = 0.0f;
+		for (const float Distance : Heap) Sum += Distance;
+
+		OutNovelty[i] = Heap.Num() ? Sum / Heap.Num() : 0.0f;
+	});
+}
+
+int32 FAINoveltyArchive::Num() const
+{
+	int32 Total = Bucket.Num();
+	for (const FAIVantagePointTree& Level : Levels) Total += Level.Num();
+
+	return Total;
+}
+
+void FAINoveltyArchive::Save(TArray<FAIBehavior>& OutBehaviors) const
+{
+	OutBehaviors.Reset(Num());
+
+	for (const FAIVantagePointTree& Level : Levels) OutBehaviors.Append(Level.GetPoints());
+
+	OutBehaviors.Append(Bucket);
+}
+
+void FAINoveltyArchive::Load(TArrayView<const FAIBehavior> Behaviors)
+{
+	Reset();
+
+	// Occupied levels are the set bits of the number of full buckets, as Add leaves them
+	const int32 Full = Behaviors.Num() / BucketSize;
+	int32 Offset = 0;
+
+	for (int32 Level = 0; (Full >> Level) != 0; Level++)
+	{
+		Levels.AddDefaulted();
+
+		if (((Full >> Level) & 1) == 0) continue;
+
+		const int32 LevelNum = BucketSize << Level;
+
+		Levels[Level].Build(TArray<FAIBehavior>(Behaviors.Slice(Offset, LevelNum)));
+		Offset += LevelNum;
+	}
+
+	Bucket.Append(Behaviors.Slice(Offset, Behaviors.Num() - Offset));
+}
+
+void FAINoveltyArchive::Reset()
+{
+	Bucket.Reset();
+	Levels.Reset();
+	PopulationTree.Reset();
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Actions whose use is part of a behavior */
+enum class EAIBehaviorAction : uint8
+{
+	Move,
+	Jump,
+	Pheromone,
+	Touch,
+	Kill,
+	Sprint,
+	Heal
+};
+
+static constexpr int32 AIBehaviorActionNum = (int32)EAIBehaviorAction::Heal + 1;
+
+/** Cells per axis of the histogram of visited locations over the known space */
+static constexpr int32 AIBehaviorCellNum = 4;
+
+/** Values of a behavior: final location, visited cells and action use */
+static constexpr int32 AIBehaviorSize = 2 + AIBehaviorCellNum * AIBehaviorCellNum + AIBehaviorActionNum;
+
+/** What an entity did over a generation, every value in the range 0.0..1.0 */
+struct FAIBehavior
+{
+	float Values[AIBehaviorSize];
+
+	static float Distance(const FAIBehavior& A, const FAIBehavior& B);
+};
+
+/** Counts an entity builds its behavior from, one cheap update per step */
+struct FAIBehaviorAccumulator
+{
+	uint32 CellSteps[AIBehaviorCellNum * AIBehaviorCellNum];
+
+	uint32 ActionSteps[AIBehaviorActionNum];
+
+	uint32 Steps;
+
+	FAIBehaviorAccumulator() { Reset(); }
+
+	void Reset() { FMemory::Memzero(this, sizeof(*this)); }
+
+	/** Count a step taken at a location of the known space between KnownMin and KnownMax */
+	void Step(const FVector2D& Location, const FVector2D& KnownMin, const FVector2D& KnownMax);
+
+	/** Count a use of an action in the current step */
+	void Act(EAIBehaviorAction Action) { ActionSteps[(int32)Action]++; }
+
+	/**
+	 * Normalize the counts into a behavior
+	 *
+	 * @param Location Final location
+	 * @param KnownMin Corner of the known space
+	 * @param KnownMax Opposite corner of the known space
+	 * @param OutBehavior Behavior of the generation so far
+	 */
+	void Describe(const FVector2D& Location, const FVector2D& KnownMin, const FVector2D& KnownMax,
+	              FAIBehavior& OutBehavior) const;
+};
+
+/** Distances to the nearest behaviors found so far, the furthest of them on top */
+using FAINeighborHeap = TArray<float, TInlineAllocator<32>>;
+
+/**
+ * Vantage-point tree over a fixed set of behaviors, laid out implicitly in one array. Queries may be
+ * capped at a number of distances and then return the nearest behaviors they reached.
+ */
+class FAIVantagePointTree
+{
+public:
+	/** Build the tree over a set of behaviors, they keep their index as id */
+	void Build(TArray<FAIBehavior>&& InPoints);
+
+	/**
+	 * Add the distances of the nearest behaviors to a heap shared with other trees
+	 *
+	 * @param Query Behavior to search around
+	 * @param K Neighbors to keep
+	 * @param Ignore Id to skip, usually the one searching
+	 * @param Checks Distances to compute at most, exact if 0
+	 * @param Heap Distances kept so far, never more than K
+	 */
+	void Search(const FAIBehavior& Query, int32 K, int32 Ignore, int32 Checks, FAINeighborHeap& Heap) const;
+
+	/** Behaviors in the tree, in the order they were built from */
+	const TArray<FAIBehavior>& GetPoints() const { return Points; }
+
+	int32 Num() const { return Points.Num(); }
+
+	void Reset();
+
+private:
+	TArray<FAIBehavior> Points;
+
+	TArray<int32> Order;
+
+	/** Distance splitting the closer and further half of the range starting at each position */
+	TArray<float> Thresholds;
+
+	/** Distance of every point to the vantage point of its range, only used while building */
+	TArray<float> Distances;
+
+	void Build(int32 Begin, int32 End);
+
+	void Search(int32 Begin, int32 End, const FAIBehavior& Query, int32 K, int32 Ignore, int32& Checks,
+	            FAINeighborHeap& Heap) const;
+};
+
+/**
+ * Behaviors that were novel in past generations. New behaviors wait in a bucket and full buckets are
+ * merged into vantage-point trees of doubling sizes.
+ */
+class FAINoveltyArchive
+{
+public:
+	/** Behaviors waiting for a tree */
+	static constexpr int32 BucketSize = 256;
+
+	void Add(const FAIBehavior& Behavior);
+
+	/**
+	 * Novelty of every behavior of a population: mean distance to its nearest behaviors in the rest
+	 * of the population and the archive
+	 *
+	 * @param Population Behavior of every entity
+	 * @param K Neighbors the mean is taken over
+	 * @param MaxChecks Distances to compute at most per entity, shared among the trees by size, exact if 0
+	 * @param OutNovelty Novelty of every entity
+	 */
+	void Score(TArrayView<const FAIBehavior> Population, int32 K, int32 MaxChecks, TArray<float>& OutNovelty);
+
+	int32 Num() const;
+
+	/** Every archived behavior in the order Load expects, tree by tree from the smallest and the bucket last */
+	void Save(TArray<FAIBehavior>& OutBehaviors) const;
+
+	/** Replace the archive with behaviors from Save, the trees are rebuilt exactly as they were */
+	void Load(TArrayView<const FAIBehavior> Behaviors);
+
+	void Reset();
+
+private:
+	TArray<FAIBehavior> Bucket;
+
+	/** Level i holds BucketSize << i behaviors or none */
+	TArray<FAIVantagePointTree> Levels;
+
+	FAIVantagePointTree PopulationTree;
+};
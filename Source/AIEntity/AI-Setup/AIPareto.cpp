@@ -0,0 +1,113 @@
+#include "AIPareto.h"
+#include "../AIEntity.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pareto Ranking"), STAT_AIParetoRanking, STATGROUP_AIEntity);
+
+void FAIParetoRanking::Rank(TArrayView<const float> Objectives, int32 ObjectiveNum, TArrayView<const int32> Members)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIParetoRanking);
+
+	const int32 Num = Members.Num();
+
+	auto Values = [&](int32 Member) { return Objectives.GetData() + Members[Member] * ObjectiveNum; };
+
+	auto Dominates = [&](int32 A, int32 B)
+	{
+		const float* ValuesA = Values(A);
+		const float* ValuesB = Values(B);
+		bool bBetter = false;
+
+		for (int32 m = 0; m < ObjectiveNum; m++)
+		{
+			if (ValuesA[m] < ValuesB[m]) return false;
+
+			bBetter |= ValuesA[m] > ValuesB[m];
+		}
+
+		return bBetter;
+	};
+
+	Order.SetNumUninitialized(Num);
+	for (int32 i = 0; i < Num; i++) Order[i] = i;
+
+	Order.Sort([&](int32 A, int32 B)
+	{
+		const float* ValuesA = Values(A);
+		const float* ValuesB = Values(B);
+
+		for (int32 m = 0; m < ObjectiveNum; m++)
+		{
+			if (ValuesA[m] != ValuesB[m]) return ValuesA[m] > ValuesB[m];
+		}
+
+		return A < B;
+	});
+
+	// Fronts only get worse, so the first front not dominating a member is found by binary search
+	Ranks.SetNumUninitialized(Num);
+	FrontNum = 0;
+
+	for (const int32 Member : Order)
+	{
+		int32 Low = 0, High = FrontNum;
+
+		while (Low < High)
+		{
+			const int32 Middle = (Low + High) / 2;
+			const TArray<int32>& Front = Fronts[Middle];
+			bool bDominated = false;
+
+			// The latest members are the closest in the sort order and the likeliest to dominate
+			for (int32 k = Front.Num() - 1; k >= 0 && !bDominated; k--) bDominated = Dominates(Front[k], Member);
+
+			if (bDominated) Low = Middle + 1;
+			else High = Middle;
+		}
+
+		if (Low == FrontNum)
+		{
+			if (Fronts.Num() == FrontNum) Fronts.AddDefaulted();
+
+			Fronts[FrontNum++].Reset();
+		}
+
+		Fronts[Low].Add(Member);
+		Ranks[Member] = Low;
+	}
+
+	const float MaxDistance = TNumericLimits<float>::Max();
+
+	// Crowding of every front along every objective, each task only writes the members of its front
+	ObjectiveCrowding.SetNum(ObjectiveNum);
+	for (TArray<float>& Distances : ObjectiveCrowding) Distances.SetNumUninitialized(Num);
+
+	ParallelFor(FrontNum * ObjectiveNum, [&](int32 Task)
+	{
+		const int32 m = Task % ObjectiveNum;
+		TArray<float>& Distances = ObjectiveCrowding[m];
+		TArray<int32, TInlineAllocator<64>> Sorted(Fronts[Task / ObjectiveNum]);
+
+		Sorted.Sort([&](int32 A, int32 B) { return Values(A)[m] < Values(B)[m]; });
+
+		const float Range = Values(Sorted.Last())[m] - Values(Sorted[0])[m];
+
+		Distances[Sorted[0]] = Distances[Sorted.Last()] = MaxDistance;
+
+		for (int32 k = 1; k < Sorted.Num() - 1; k++)
+		{
+			Distances[Sorted[k]] = Range > 0.0f ? (Values(Sorted[k + 1])[m] - Values(Sorted[k - 1])[m]) / Range : 0.0f;
+		}
+	});
+
+	Crowding.SetNumUninitialized(Num);
+
+	ParallelFor(Num, [&](int32 i)
+	{
+		// Ends of a front stay the largest distance instead of overflowing
+		float Distance = 0.0f;
+		for (int32 m = 0; m < ObjectiveNum; m++) Distance = FMath::Min(Distance + ObjectiveCrowding[m][i], MaxDistance);
+
+		Crowding[i] = Distance;
+	});
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Ranks a population on several objectives at once, all maximized, into Pareto fronts by efficient
+ * non-dominated sorting and into crowding distances inside a front
+ */
+class FAIParetoRanking
+{
+public:
+	/**
+	 * Sort entities into fronts and measure their crowding
+	 *
+	 * @param Objectives Objectives of every entity, ObjectiveNum values per entity
+	 * @param ObjectiveNum Objectives per entity
+	 * @param Members Entities to rank, the results are indexed like them
+	 */
+	void Rank(TArrayView<const float> Objectives, int32 ObjectiveNum, TArrayView<const int32> Members);
+
+	/** Front of a ranked member, 0 for the non-dominated one */
+	int32 GetRank(int32 Member) const { return Ranks[Member]; }
+
+	/** Normalized distance to the neighbors of a ranked member in its front, infinite at the ends */
+	float GetCrowding(int32 Member) const { return Crowding[Member]; }
+
+	/** Crowded comparison of two ranked members: the better front wins, then the less crowded member */
+	bool IsBetter(int32 A, int32 B) const
+	{
+		return Ranks[A] != Ranks[B] ? Ranks[A] < Ranks[B] : Crowding[A] > Crowding[B];
+	}
+
+	/** Fronts of the last ranking */
+	int32 GetFrontNum() const { return FrontNum; }
+
+private:
+	TArray<int32> Ranks;
+	TArray<float> Crowding;
+
+	/** Members sorted lexicographically, best first */
+	TArray<int32> Order;
+
+	/** Members of every front in the order they joined, only the first FrontNum are in use */
+	TArray<TArray<int32>> Fronts;
+	int32 FrontNum = 0;
+
+	/** Crowding of every member along each objective */
+	TArray<TArray<float>> ObjectiveCrowding;
+};
@@ -0,0 +1,1141 @@
+#include "AIPopulationSubsystem.h"
+#include "AIEntityCharacter.h"
+#include "../AIEntity.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Engine/GameViewportClient.h"
+
+static TAutoConsoleVariable<int32> CVarAISeed(
+	TEXT("AIEntity.Seed"),
+	0,
+	TEXT("Seed of the population random streams, 0 picks a new seed every run")
+);
+
+static TAutoConsoleVariable<int32> CVarAISnapshotInterval(
+	TEXT("AIEntity.SnapshotInterval"),
+	0,
+	TEXT("Generations between automatic snapshots, 0 disables them")
+);
+
+DECLARE_CYCLE_STAT(TEXT("Snapshot Capture"), STAT_AISnapshotCapture, STATGROUP_AIEntity);
+DECLARE_CYCLE_STAT(TEXT("Snapshot Load"), STAT_AISnapshotLoad, STATGROUP_AIEntity);
+
+static FString DefaultSnapshotPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Snapshot.aisn");
+}
+
+static TAutoConsoleVariable<bool> CVarAIJournal(
+	TEXT("AIEntity.Journal"),
+	false,
+	TEXT("Journal every generation turnover between snapshots so a run can be recovered")
+);
+
+/** Journal continuing a snapshot */
+static FString JournalPath(const FString& SnapshotPath)
+{
+	return FPaths::ChangeExtension(SnapshotPath, TEXT("aijr"));
+}
+
+static TAutoConsoleVariable<bool> CVarAIGenerationLog(
+	TEXT("AIEntity.GenerationLog"),
+	false,
+	TEXT("Log the survival, genome length and wiring of every entity each generation to a columnar file")
+);
+
+DECLARE_CYCLE_STAT(TEXT("Generation Log Fill"), STAT_AIGenerationLogFill, STATGROUP_AIEntity);
+
+static FString DefaultGenerationLogPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Generations.aigl");
+}
+
+static FAutoConsoleCommand CmdAIGenerationLogSummary(
+	TEXT("AIEntity.GenerationLogSummary"),
+	TEXT("Log the survival rate and mean genome length of every generation in a generation log. ")
+	TEXT("Usage: AIEntity.GenerationLogSummary [Path]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Path = Args.IsEmpty() ? DefaultGenerationLogPath() : Args[0];
+
+		const bool bRead = FAIGenerationLogReader::Read(Path, [](const FAIGenerationColumns& Columns)
+		{
+			int64 GenomeLength = 0;
+			for (uint16 Length : Columns.GenomeLength) GenomeLength += Length;
+
+			UE_LOG(LogAIEntity, Log, TEXT("Generation %u: %d entities, %.1f%% survived, %.1f genes"),
+			       Columns.Generation, Columns.Num(), Columns.SurvivalRate() * 100.0f,
+			       Columns.Num() ? (double)GenomeLength / Columns.Num() : 0.0);
+		});
+
+		if (!bRead) UE_LOG(LogAIEntity, Warning, TEXT("Could not read generation log %s"), *Path);
+	})
+);
+
+static TAutoConsoleVariable<bool> CVarAIReplay(
+	TEXT("AIEntity.Replay"),
+	false,
+	TEXT("Record the run as keyframes and journals that any generation can be rebuilt from, ")
+	TEXT("replaces AIEntity.SnapshotInterval while on")
+);
+
+static TAutoConsoleVariable<int32> CVarAIReplayKeyframeInterval(
+	TEXT("AIEntity.Replay.KeyframeInterval"),
+	100,
+	TEXT("Generations between the keyframes of a recorded run")
+);
+
+static TAutoConsoleVariable<float> CVarAIReplayStepSeconds(
+	TEXT("AIEntity.Replay.StepSeconds"),
+	1.0f / 30.0f,
+	TEXT("Fixed time step of every step while recording or fast-forwarding a replay. The engine runs on it ")
+	TEXT("as a whole, the previous time step is restored once recording and fast-forwarding stop")
+);
+
+static TAutoConsoleVariable<bool> CVarAIMating(
+	TEXT("AIEntity.Mating"),
+	false,
+	TEXT("Pair surviving pheromone emitters at every turnover and cross their genomes over")
+);
+
+static TAutoConsoleVariable<float> CVarAIMateDistance(
+	TEXT("AIEntity.MateDistance"),
+	1000.0f,
+	TEXT("Distance pheromone emitters pair up within")
+);
+
+static TAutoConsoleVariable<bool> CVarAILineage(
+	TEXT("AIEntity.Lineage"),
+	false,
+	TEXT("Record the parent and mutations of every child so any ancestor genome can be rebuilt")
+);
+
+static TAutoConsoleVariable<int32> CVarAILineageAnchorInterval(
+	TEXT("AIEntity.Lineage.AnchorInterval"),
+	50,
+	TEXT("Generations between lineage anchors storing every genome in full")
+);
+
+static TAutoConsoleVariable<bool> CVarAISteadyState(
+	TEXT("AIEntity.SteadyState"),
+	false,
+	TEXT("Replace dead and aged out entities continuously with children of fit ones instead of turning ")
+	TEXT("every generation over at once")
+);
+
+static TAutoConsoleVariable<bool> CVarAIMultiObjective(
+	TEXT("AIEntity.MultiObjective"),
+	false,
+	TEXT("Pick parents by Pareto rank and crowding over survival, exploration, energy and diversity")
+);
+
+static TAutoConsoleVariable<bool> CVarAINovelty(
+	TEXT("AIEntity.Novelty"),
+	false,
+	TEXT("Score the novelty of every behavior against the population and an archive, and select on it ")
+	TEXT("along with the other objectives")
+);
+
+static TAutoConsoleVariable<int32> CVarAINoveltyNeighbors(
+	TEXT("AIEntity.Novelty.Neighbors"),
+	15,
+	TEXT("Nearest behaviors the novelty of a behavior is the mean distance to")
+);
+
+static TAutoConsoleVariable<int32> CVarAINoveltyArchiveRate(
+	TEXT("AIEntity.Novelty.ArchiveRate"),
+	4,
+	TEXT("Most novel behaviors archived every generation")
+);
+
+static TAutoConsoleVariable<int32> CVarAINoveltyMaxChecks(
+	TEXT("AIEntity.Novelty.MaxChecks"),
+	4096,
+	TEXT("Behavior distances computed at most to score one entity, bounds the cost as the archive grows. ")
+	TEXT("0 searches exactly")
+);
+
+static FAutoConsoleCommand CmdAITraceLineage(
+	TEXT("AIEntity.TraceLineage"),
+	TEXT("Walk the ancestors of an entity and rebuild its genome. ")
+	TEXT("Usage: AIEntity.TraceLineage Seed Generation Entity"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 3) return;
+
+		uint32 Seed = 0;
+		FAILineageId Id = {0, 0};
+		LexFromString(Seed, *Args[0]);
+		LexFromString(Id.Generation, *Args[1]);
+		LexFromString(Id.Entity, *Args[2]);
+
+		const FString Directory = FAIReplayIndex::RunDirectory(Seed);
+		FAILineageReader Reader;
+		TArray<FAILineageId> Ancestors;
+		TArray<FAIGene> Genome;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		if (!Reader.Open(Directory) || !Reader.Ancestors(Id, Ancestors) || !Reader.Reconstruct(Id, Genome))
+		{
+			UE_LOG(LogAIEntity, Warning, TEXT("Generation %u entity %d is not in the lineage in %s"), Id.Generation,
+			       Id.Entity, *Directory);
+			return;
+		}
+
+		UE_LOG(LogAIEntity, Log, TEXT("Generation %u entity %d: %d ancestors, %d genes, traced in %.3f ms"),
+		       Id.Generation, Id.Entity, Ancestors.Num(), Genome.Num(),
+		       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAISeek(
+	TEXT("AIEntity.Seek"),
+	TEXT("Rebuild a generation of a recorded run and fast-forward to a step of it. ")
+	TEXT("Usage: AIEntity.Seek Generation [Step] [Seed]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UAIPopulationSubsystem* Population = World ? World->GetSubsystem<UAIPopulationSubsystem>() : nullptr;
+
+		if (!Population || Args.IsEmpty()) return;
+
+		uint32 Generation = 0, Step = 0, Seed = 0;
+		LexFromString(Generation, *Args[0]);
+		if (Args.Num() > 1) LexFromString(Step, *Args[1]);
+		if (Args.Num() > 2) LexFromString(Seed, *Args[2]);
+
+		Population->Seek(Generation, Step, Seed);
+	})
+);
+
+static FString DefaultSensorRecordingPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Sensors.aisr");
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAIRecordSensors(
+	TEXT("AIEntity.RecordSensors"),
+	TEXT("Start or stop recording the sensor vectors of every brain. Usage: AIEntity.RecordSensors [Path]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UAIPopulationSubsystem* Population = World ? World->GetSubsystem<UAIPopulationSubsystem>() : nullptr)
+			Population->ToggleSensorRecording(Args.IsEmpty() ? FString() : Args[0]);
+	})
+);
+
+static FAutoConsoleCommand CmdAIReplaySensors(
+	TEXT("AIEntity.ReplaySensors"),
+	TEXT("Replay a sensor recording through the brains and log the timings. Usage: AIEntity.ReplaySensors [Path]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Path = Args.IsEmpty() ? DefaultSensorRecordingPath() : Args[0];
+		FAISensorReplayReport Report;
+
+		if (!FAISensorReplay::Run(Path, Report))
+		{
+			UE_LOG(LogAIEntity, Warning, TEXT("Could not replay sensor recording %s"), *Path);
+			return;
+		}
+
+		UE_LOG(LogAIEntity, Log,
+		       TEXT("Replayed %d genomes, %d wirings and %d steps, %d mismatches, wiring %.3f ms, evaluation %.3f ms"),
+		       Report.Genomes, Report.Wirings, Report.Steps, Report.Mismatches, Report.WireSeconds * 1000.0,
+		       Report.EvaluateSeconds * 1000.0);
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAISaveSnapshot(
+	TEXT("AIEntity.SaveSnapshot"),
+	TEXT("Write the simulation state to a snapshot. Usage: AIEntity.SaveSnapshot [Path]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UAIPopulationSubsystem* Population = World ? World->GetSubsystem<UAIPopulationSubsystem>() : nullptr)
+			Population->SaveSnapshot(Args.IsEmpty() ? FString() : Args[0]);
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAILoadSnapshot(
+	TEXT("AIEntity.LoadSnapshot"),
+	TEXT("Resume the simulation from a snapshot. Usage: AIEntity.LoadSnapshot [Path]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UAIPopulationSubsystem* Population = World ? World->GetSubsystem<UAIPopulationSubsystem>() : nullptr)
+			Population->LoadSnapshot(Args.IsEmpty() ? FString() : Args[0]);
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs CmdAIRecover(
+	TEXT("AIEntity.Recover"),
+	TEXT("Resume from a snapshot and replay its journal. Usage: AIEntity.Recover [SnapshotPath]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UAIPopulationSubsystem* Population = World ? World->GetSubsystem<UAIPopulationSubsystem>() : nullptr)
+			Population->Recover(Args.IsEmpty() ? FString() : Args[0]);
+	})
+);
+
+void UAIPopulationSubsystem::Deinitialize()
+{
+	SensorRecorder.Close();
+	CompleteSnapshot(true);
+	Journal.Close();
+	GenerationLog.Close();
+	ReplayIndex.Close();
+	Lineage.Close();
+
+	StopFastForward();
+	SetFixedStep(false);
+
+	Super::Deinitialize();
+}
+
+void UAIPopulationSubsystem::ToggleSensorRecording(const FString& Path)
+{
+	if (SensorRecorder.IsRecording())
+	{
+		UE_LOG(LogAIEntity, Log, TEXT("Stopped sensor recording %s"), *SensorRecorder.GetPath());
+		SensorRecorder.Close();
+		return;
+	}
+
+	if (SensorRecorder.Open(Path.IsEmpty() ? DefaultSensorRecordingPath() : Path))
+		UE_LOG(LogAIEntity, Log, TEXT("Recording sensors to %s"), *SensorRecorder.GetPath());
+}
+
+TStatId UAIPopulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAIPopulationSubsystem, STATGROUP_Tickables);
+}
+
+void UAIPopulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Intents of entities that all left the population since emitting
+	if (Entities.IsEmpty())
+	{
+		Interactions.Reset();
+		return;
+	}
+
+	// Entities interact only once all of them acted
+	Interactions.Commit(Entities, Traits);
+
+	// Traits advance for everyone at once, entities out of health die
+	Traits.Step();
+
+	for (int32 i = 0; i < Entities.Num(); i++)
+	{
+		if (Entities[i]->IsAlive() && Traits.Health[i] <= 0.0f) Entities[i]->Kill();
+	}
+
+	// The time step of the next frame, recorded movement is repeated only on the same steps
+	SetFixedStep(IsRecordingReplay() || bFastForwarding);
+
+	// Entities took the current step in their own tick
+	++CurrentStep;
+
+	CompleteSnapshot(false);
+
+	// Generation 0 is keyframed after its first step, turnovers keyframe every later one
+	if (IsRecordingReplay() && !ReplayIndex.IsOpen() && GenerationEngine.GetGeneration() == 0) RecordKeyframe();
+
+	if (bFastForwarding && CurrentStep >= FastForwardStep) StopFastForward();
+
+	if (CVarAISteadyState.GetValueOnGameThread())
+	{
+		// Replacements are selected on survival alone
+		const bool bObjectives = CVarAINovelty.GetValueOnGameThread() || CVarAIMultiObjective.GetValueOnGameThread();
+
+		if (bObjectives && !bObjectivesIgnoredLogged)
+			UE_LOG(LogAIEntity, Warning, TEXT("AIEntity.Novelty and AIEntity.MultiObjective only select at turnovers, ")
+			       TEXT("they have no effect while AIEntity.SteadyState is on"));
+
+		bObjectivesIgnoredLogged = bObjectives;
+
+		// No barrier, the step only keeps the oscillators in phase
+		if (CurrentStep >= GenerationParams.StepsPerGeneration) CurrentStep = 0;
+
+		ReplaceExpired();
+		return;
+	}
+
+	if (CurrentStep < GenerationParams.StepsPerGeneration) return;
+
+	// The turnover is journaled against the last snapshot, which had a whole generation to reach disk
+	CompleteSnapshot(true);
+
+	GatherSurvival();
+
+	const bool bReplay = IsRecordingReplay();
+	const bool bJournal = bReplay || CVarAIJournal.GetValueOnGameThread();
+
+	const bool bLineage = CVarAILineage.GetValueOnGameThread();
+
+	GenerationParams.bMating = CVarAIMating.GetValueOnGameThread();
+	GenerationParams.MateDistance = CVarAIMateDistance.GetValueOnGameThread();
+
+	GenerationEngine.SetRecordDelta((bJournal && Journal.IsOpen()) || (bLineage && Lineage.IsOpen()));
+
+	// Novelty is selected on as one more objective
+	const bool bNovelty = CVarAINovelty.GetValueOnGameThread();
+
+	GenerationParams.bMultiObjective = CVarAIMultiObjective.GetValueOnGameThread() || bNovelty;
+
+	if (bNovelty) ScoreNovelty();
+	else Novelty.Reset();
+
+	if (GenerationParams.bMultiObjective) FillObjectives();
+
+	GenerationEngine.Turnover(Entities, GenomeArena, GenerationParams, Surviving,
+	                          GenerationParams.bMultiObjective ? TArrayView<const float>(Objectives)
+	                                                           : TArrayView<const float>());
+	BuildSpecies();
+
+	CurrentStep = 0;
+
+	if (bJournal && Journal.IsOpen()) Journal.Append(GenerationEngine.GetLastDelta());
+	else if (!bJournal) Journal.Close();
+
+	if (bLineage)
+	{
+		const FAIGenomeArena::FReadScope ReadScope(GenomeArena);
+		TArray<TArrayView<const FAIGene>> Genomes;
+		GatherGenomes(Genomes);
+
+		// A lineage is reopened with an anchor of the generation that just started
+		if (Lineage.IsOpen()) Lineage.Append(GenerationEngine.GetLastDelta(), Genomes);
+		else
+			Lineage.Open(FAIReplayIndex::RunDirectory(RunSeed), RunSeed, GenerationEngine.GetGeneration(),
+			             CVarAILineageAnchorInterval.GetValueOnGameThread(), Genomes);
+	}
+	else Lineage.Close();
+
+	UpdateGenerationLog();
+
+	if (bReplay)
+	{
+		RecordKeyframe();
+		return;
+	}
+
+	ReplayIndex.Close();
+
+	// A journal always continues from a snapshot
+	const int32 SnapshotInterval = CVarAISnapshotInterval.GetValueOnGameThread();
+
+	if ((SnapshotInterval > 0 && GenerationEngine.GetGeneration() % SnapshotInterval == 0) ||
+		(bJournal && !Journal.IsOpen()))
+		SaveSnapshot(FString());
+}
+
+bool UAIPopulationSubsystem::IsRecordingReplay() const
+{
+	return !bPlayback && CVarAIReplay.GetValueOnGameThread() && !CVarAISteadyState.GetValueOnGameThread();
+}
+
+void UAIPopulationSubsystem::GatherSurvival()
+{
+	PrepareLikenessQueries();
+
+	// Without any interested target the generation is only about staying alive
+	bool bHasTargets = LikenessIndex.GetTree(EAIEntityState::Interested).Num() > 0;
+
+	for (const TPair<TWeakObjectPtr<AActor>, EAIEntityState>& Likeness : LikenessActors)
+		bHasTargets |= Likeness.Value == EAIEntityState::Interested && Likeness.Key.IsValid();
+
+	const int32 Num = Entities.Num();
+
+	Locations.SetNumUninitialized(Num);
+	Surviving.SetNumUninitialized(Num);
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		Locations[i] = Entities[i]->GetActorLocation();
+		Surviving[i] = Entities[i]->IsAlive();
+	}
+
+	if (!bHasTargets) return;
+
+	// Only the prepared queries and the copied locations are read from the workers
+	ParallelFor(Num, [this](int32 i)
+	{
+		FVector2D Target;
+
+		Surviving[i] = Surviving[i] && FindNearestPreparedLikeness(EAIEntityState::Interested, Locations[i],
+		                                                           GenerationParams.SurvivalDistance, Target);
+	});
+}
+
+void UAIPopulationSubsystem::FillObjectives()
+{
+	const int32 Num = Entities.Num();
+
+	// Diversity is measured on the species of the generation that is ending
+	if (bSpeciesStale)
+	{
+		GenerationEngine.Sign(Entities, GenomeArena);
+		BuildSpecies();
+	}
+
+	// Novelty is scaled so the most novel entity of the generation scores 1.0
+	const bool bHasNovelty = Novelty.Num() == Num;
+	float NoveltyScale = 0.0f;
+
+	if (bHasNovelty)
+	{
+		for (const float Score : Novelty) NoveltyScale = FMath::Max(NoveltyScale, Score);
+
+		NoveltyScale = NoveltyScale > 0.0f ? 1.0f / NoveltyScale : 0.0f;
+	}
+
+	Objectives.SetNumUninitialized(Num * AIObjectiveNum);
+
+	ParallelFor(Num, [&](int32 i)
+	{
+		const AAIEntityCharacter& Entity = *Entities[i];
+		float* Values = Objectives.GetData() + i * AIObjectiveNum;
+
+		Values[(int32)EAIObjective::Survival] = Surviving[i] ? 1.0f : 0.0f;
+		Values[(int32)EAIObjective::Exploration] = Entity.GetExploredFraction();
+		Values[(int32)EAIObjective::Energy] = (Traits.Health[i] + Traits.Stamina[i]) * 0.5f;
+		Values[(int32)EAIObjective::Diversity] = 1.0f - (float)Species.GetSpeciesSize(i) / Num;
+		Values[(int32)EAIObjective::Novelty] = bHasNovelty ? Novelty[i] * NoveltyScale : 0.0f;
+	});
+}
+
+void UAIPopulationSubsystem::ScoreNovelty()
+{
+	const int32 Num = Entities.Num();
+
+	Behaviors.SetNumUninitialized(Num);
+
+	// Locations were read on the game thread along with survival
+	check(Locations.Num() == Num);
+
+	ParallelFor(Num, [this](int32 i)
+	{
+		Entities[i]->GetBehavior(Locations[i], Behaviors[i]);
+	});
+
+	NoveltyArchive.Score(Behaviors, FMath::Max(1, CVarAINoveltyNeighbors.GetValueOnGameThread()),
+	                     FMath::Max(0, CVarAINoveltyMaxChecks.GetValueOnGameThread()), Novelty);
+
+	// The most novel behaviors are kept so later generations are pushed away from them too
+	NoveltyOrder.SetNumUninitialized(Num);
+	for (int32 i = 0; i < Num; i++) NoveltyOrder[i] = i;
+
+	NoveltyOrder.Sort([this](int32 A, int32 B) { return Novelty[A] > Novelty[B]; });
+
+	const int32 ArchiveNum = FMath::Clamp(CVarAINoveltyArchiveRate.GetValueOnGameThread(), 0, Num);
+	for (int32 i = 0; i < ArchiveNum; i++) NoveltyArchive.Add(Behaviors[NoveltyOrder[i]]);
+
+	UE_LOG(LogAIEntity, Verbose, TEXT("Novelty: highest %.3f, %d behaviors archived"),
+	       Num ? Novelty[NoveltyOrder[0]] : 0.0f, NoveltyArchive.Num());
+}
+
+void UAIPopulationSubsystem::BuildSpecies()
+{
+	Species.Build(GenerationEngine.GetSignatures());
+	bSpeciesStale = false;
+
+	const FAISpeciesStats& SpeciesStats = Species.GetStats();
+
+	UE_LOG(LogAIEntity, Log, TEXT("Generation %u: %d species, %d unique genomes, largest species %d, diversity %.3f"),
+	       GenerationEngine.GetGeneration(), SpeciesStats.SpeciesNum, SpeciesStats.UniqueGenomes,
+	       SpeciesStats.LargestSpecies, SpeciesStats.Diversity);
+}
+
+void UAIPopulationSubsystem::UpdateGenerationLog()
+{
+	if (CVarAIGenerationLog.GetValueOnGameThread())
+	{
+		// Only the first log of the world starts a new file, turning the log back on continues it
+		if (!GenerationLog.IsOpen() && GenerationLog.Open(DefaultGenerationLogPath(), bGenerationLogStarted))
+			bGenerationLogStarted = true;
+
+		LogGeneration();
+	}
+	else GenerationLog.Close();
+}
+
+void UAIPopulationSubsystem::ReplaceExpired()
+{
+	// Journals, lineage and replays record whole turnovers, they start over once the barrier is back
+	Journal.Close();
+	Lineage.Close();
+	ReplayIndex.Close();
+
+	ExpiredSlots.Reset();
+	AgedSlots.Reset();
+
+	for (int32 i = 0; i < Entities.Num(); i++)
+	{
+		if (!Entities[i]->IsAlive()) ExpiredSlots.Add(i);
+		else if (Entities[i]->GetAge() >= GenerationParams.StepsPerGeneration) AgedSlots.Add(i);
+	}
+
+	// Only the oldest age out every step, so births spread over the generation instead of bunching up
+	const int32 MaxAged = FMath::DivideAndRoundUp(Entities.Num(),
+	                                              (int32)FMath::Max(1u, GenerationParams.StepsPerGeneration));
+
+	if (AgedSlots.Num() > MaxAged)
+	{
+		AgedSlots.Sort([this](int32 A, int32 B) { return Entities[A]->GetAge() > Entities[B]->GetAge(); });
+		AgedSlots.SetNum(MaxAged, EAllowShrinking::No);
+	}
+
+	ExpiredSlots.Append(AgedSlots);
+
+	if (ExpiredSlots.IsEmpty()) return;
+
+	GatherSurvival();
+
+	// Replace only signs the children it makes
+	if (bSpeciesStale) GenerationEngine.Sign(Entities, GenomeArena);
+
+	const int32 Generations = GenerationEngine.Replace(Entities, GenomeArena, GenerationParams, Surviving,
+	                                                   ExpiredSlots);
+
+	if (Generations == 0) return;
+
+	BuildSpecies();
+	UpdateGenerationLog();
+
+	const int32 SnapshotInterval = CVarAISnapshotInterval.GetValueOnGameThread();
+
+	if (SnapshotInterval > 0 && GenerationEngine.GetGeneration() % SnapshotInterval < (uint32)Generations)
+		SaveSnapshot(FString());
+}
+
+void UAIPopulationSubsystem::RecordKeyframe()
+{
+	const FString Directory = FAIReplayIndex::RunDirectory(RunSeed);
+
+	if (!ReplayIndex.IsOpen() && !ReplayIndex.Open(Directory, RunSeed, Entities.Num())) return;
+
+	const uint32 Generation = GenerationEngine.GetGeneration();
+	const int32 Interval = FMath::Max(1, CVarAIReplayKeyframeInterval.GetValueOnGameThread());
+
+	// Every journal continues from a keyframe, so the first turnover recorded starts one
+	if (Generation % Interval != 0 && Journal.IsOpen()) return;
+
+	SaveSnapshot(FAIReplayIndex::KeyframePath(Directory, Generation));
+
+	// Indexed only once on disk, a seek never finds a keyframe that is missing or half written
+	bPendingKeyframe = true;
+}
+
+void UAIPopulationSubsystem::CompleteSnapshot(bool bWait)
+{
+	if (!bWait && SnapshotWriter.IsWriting()) return;
+
+	const bool bWritten = SnapshotWriter.Wait();
+
+	// A failed write leaves the previous snapshot and its journal in charge
+	if (bWritten && !PendingJournalPath.IsEmpty()) Journal.Open(PendingJournalPath, RunSeed, PendingGeneration);
+	if (bWritten && bPendingKeyframe && ReplayIndex.IsOpen()) ReplayIndex.AddKeyframe(PendingGeneration);
+
+	PendingJournalPath.Reset();
+	bPendingKeyframe = false;
+}
+
+bool UAIPopulationSubsystem::Seek(uint32 Generation, uint32 Step, uint32 Seed)
+{
+	const FString Directory = FAIReplayIndex::RunDirectory(Seed ? Seed : RunSeed);
+
+	FAIReplayIndexHeader Header;
+	TArray<uint32> Keyframes;
+
+	if (!FAIReplayIndex::Load(Directory, Header, Keyframes))
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("No replay recorded in %s"), *Directory);
+		return false;
+	}
+
+	const int32 Keyframe = FAIReplayIndex::FindKeyframe(Keyframes, Generation);
+
+	if (Keyframe == INDEX_NONE)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Replay in %s starts after generation %u"), *Directory, Generation);
+		return false;
+	}
+
+	// The recording would overwrite the keyframes being watched
+	CompleteSnapshot(true);
+	bPlayback = true;
+	ReplayIndex.Close();
+	Journal.Close();
+
+	const FString KeyframePath = FAIReplayIndex::KeyframePath(Directory, Keyframes[Keyframe]);
+
+	if (!LoadSnapshot(KeyframePath)) return false;
+
+	ReplayJournal(KeyframePath, Generation);
+
+	if (GenerationEngine.GetGeneration() != Generation)
+		UE_LOG(LogAIEntity, Warning, TEXT("Replay in %s only reaches generation %u"), *Directory,
+		       GenerationEngine.GetGeneration());
+
+	StartFastForward(FMath::Min(Step, GenerationParams.StepsPerGeneration - 1));
+
+	return true;
+}
+
+void UAIPopulationSubsystem::SetFixedStep(bool bEnable)
+{
+	if (bEnable)
+	{
+		if (!bFixedStep)
+		{
+			bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+			SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+			bFixedStep = true;
+		}
+
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(CVarAIReplayStepSeconds.GetValueOnGameThread());
+	}
+	else if (bFixedStep)
+	{
+		FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+		bFixedStep = false;
+	}
+}
+
+void UAIPopulationSubsystem::StartFastForward(unsigned Step)
+{
+	FastForwardStep = Step;
+
+	if (CurrentStep >= FastForwardStep)
+	{
+		StopFastForward();
+		return;
+	}
+
+	bFastForwarding = true;
+	SetFixedStep(true);
+
+	// Frames only tick the world until the step is reached
+	if (UGameViewportClient* Viewport = GetWorld()->GetGameViewport()) Viewport->bDisableWorldRendering = true;
+
+	UE_LOG(LogAIEntity, Log, TEXT("Fast-forwarding generation %u to step %u"), GenerationEngine.GetGeneration(),
+	       FastForwardStep);
+}
+
+void UAIPopulationSubsystem::StopFastForward()
+{
+	if (!bFastForwarding) return;
+
+	bFastForwarding = false;
+
+	if (UGameViewportClient* Viewport = GetWorld()->GetGameViewport()) Viewport->bDisableWorldRendering = false;
+}
+
+void UAIPopulationSubsystem::GatherGenomes(TArray<TArrayView<const FAIGene>>& OutGenomes) const
+{
+	OutGenomes.SetNumUninitialized(Entities.Num());
+
+	for (int32 i = 0; i < Entities.Num(); i++) OutGenomes[i] = Entities[i]->GetGenome();
+}
+
+void UAIPopulationSubsystem::LogGeneration()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIGenerationLogFill);
+
+	FAIGenerationColumns Columns;
+	Columns.Generation = GenerationEngine.GetGeneration();
+	Columns.SetNum(Entities.Num());
+
+	for (int32 i = 0; i < Entities.Num(); i++)
+	{
+		const AAIEntityCharacter* Entity = Entities[i];
+
+		Columns.SuccessRate[i] = Entity->HasSurvived();
+		Columns.GenomeLength[i] = (uint16)FMath::Min(Entity->GetGenomeSpan().Num, (int32)MAX_uint16);
+		Columns.WiredSensors[i] = Entity->GetNeuralNet().WiredSensors;
+		Columns.WiredActions[i] = Entity->GetNeuralNet().WiredActions;
+	}
+
+	// Compressed and written on the log thread
+	GenerationLog.Submit(MoveTemp(Columns));
+}
+
+bool UAIPopulationSubsystem::Recover(const FString& Path)
+{
+	const FString SnapshotPath = Path.IsEmpty() ? DefaultSnapshotPath() : Path;
+
+	// The journal of this run may be the one about to be read
+	CompleteSnapshot(true);
+	Journal.Close();
+
+	if (!LoadSnapshot(SnapshotPath)) return false;
+
+	const int32 Replayed = ReplayJournal(SnapshotPath, MAX_uint32);
+
+	UE_LOG(LogAIEntity, Log, TEXT("Recovered generation %u, %d generations replayed from the journal"),
+	       GenerationEngine.GetGeneration(), Replayed);
+
+	// Keep journaling from the recovered state
+	if (CVarAIJournal.GetValueOnGameThread()) SaveSnapshot(SnapshotPath);
+
+	return true;
+}
+
+int32 UAIPopulationSubsystem::ReplayJournal(const FString& SnapshotPath, uint32 LastGeneration)
+{
+	const uint32 SnapshotGeneration = GenerationEngine.GetGeneration();
+
+	FAIJournalHeader Header;
+	int32 Replayed = 0;
+	bool bMismatch = false, bInvalid = false;
+
+	FAIJournal::Read(JournalPath(SnapshotPath), Header, [&](const FAIGenerationDelta& Delta)
+	{
+		// A journal started from another snapshot does not continue this one
+		bMismatch |= Header.RunSeed != RunSeed || Header.BaseGeneration != SnapshotGeneration ||
+			Delta.Survived.Num() != Entities.Num();
+
+		if (bMismatch || bInvalid || Delta.Generation != GenerationEngine.GetGeneration() + 1 ||
+			Delta.Generation > LastGeneration)
+			return;
+
+		// Records of a journal written under other rules would write outside the child genomes
+		bInvalid = !FAIGenerationEngine::CanReplay(Entities, GenerationParams, Delta);
+		if (bInvalid) return;
+
+		GenerationEngine.Replay(Entities, GenomeArena, GenerationParams, Delta);
+		Replayed++;
+	});
+
+	if (bMismatch) UE_LOG(LogAIEntity, Warning, TEXT("Journal does not continue snapshot %s"), *SnapshotPath);
+
+	if (bInvalid)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Journal of snapshot %s does not fit the population after generation %u"),
+		       *SnapshotPath, GenerationEngine.GetGeneration());
+	}
+
+	if (Replayed > 0)
+	{
+		GenerationEngine.Finish(Entities, GenomeArena, GenerationParams);
+		Species.Build(GenerationEngine.GetSignatures());
+		bSpeciesStale = false;
+		CurrentStep = 0;
+	}
+
+	return Replayed;
+}
+
+void UAIPopulationSubsystem::SaveSnapshot(const FString& Path)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AISnapshotCapture);
+
+	// The buffer of the previous snapshot is reused, its journal and keyframe are taken care of first
+	CompleteSnapshot(true);
+
+	// New entities are wired first so their neuron outputs are stored
+	WirePendingEntities();
+
+	FAISnapshotHeader Header;
+	Header.RunSeed = RunSeed;
+	Header.Generation = GenerationEngine.GetGeneration();
+	Header.Step = CurrentStep;
+	Header.MaxNumberNeurons = GenerationParams.MaxNumberNeurons;
+	Header.EntityNum = Entities.Num();
+
+	// Genomes are stored back to back without the gaps of the arena. States are zeroed so the padding
+	// written out is the same on every save
+	TArray<FAISnapshotEntity> States;
+	TArray<float> Neurons;
+	States.SetNumZeroed(Entities.Num());
+
+	for (int32 i = 0; i < Entities.Num(); i++)
+	{
+		Entities[i]->SaveState(States[i], Neurons);
+		States[i].Genome = {Header.GeneNum, Entities[i]->GetGenomeSpan().Num};
+		Header.GeneNum += States[i].Genome.Num;
+	}
+
+	Header.NeuronNum = Neurons.Num();
+
+	// A resumed run measures novelty against the same past
+	TArray<FAIBehavior> Archive;
+	NoveltyArchive.Save(Archive);
+	Header.ArchiveNum = Archive.Num();
+
+	SnapshotWriter.Begin(Header);
+
+	FMemory::Memcpy(SnapshotWriter.GetEntities().GetData(), States.GetData(),
+	                States.Num() * sizeof(FAISnapshotEntity));
+	FMemory::Memcpy(SnapshotWriter.GetNeurons().GetData(), Neurons.GetData(), Neurons.Num() * sizeof(float));
+	FMemory::Memcpy(SnapshotWriter.GetArchive().GetData(), Archive.GetData(), Archive.Num() * sizeof(FAIBehavior));
+
+	FAIGene* Genes = SnapshotWriter.GetGenes().GetData();
+	const FAIGenomeArena::FReadScope ReadScope(GenomeArena);
+
+	for (int32 i = 0; i < Entities.Num(); i++)
+	{
+		const TArrayView<const FAIGene> Genome = Entities[i]->GetGenome();
+		FMemory::Memcpy(Genes + States[i].Genome.Offset, Genome.GetData(), Genome.Num() * sizeof(FAIGene));
+	}
+
+	const FString SnapshotPath = Path.IsEmpty() ? DefaultSnapshotPath() : Path;
+	SnapshotWriter.WriteAsync(SnapshotPath);
+	PendingGeneration = Header.Generation;
+
+	// Turnovers from here on are journaled against this snapshot. The journal of the previous one is only
+	// dropped once the new snapshot is on disk, a crash in between still recovers from the old pair
+	if ((CVarAIJournal.GetValueOnGameThread() && !CVarAISteadyState.GetValueOnGameThread()) || IsRecordingReplay())
+		PendingJournalPath = JournalPath(SnapshotPath);
+}
+
+bool UAIPopulationSubsystem::LoadSnapshot(const FString& Path)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AISnapshotLoad);
+
+	const FString SnapshotPath = Path.IsEmpty() ? DefaultSnapshotPath() : Path;
+
+	// A snapshot of this run may still be on its way to disk
+	CompleteSnapshot(true);
+
+	FAISnapshotReader Reader;
+
+	if (!Reader.Open(SnapshotPath))
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Could not read snapshot %s"), *SnapshotPath);
+		return false;
+	}
+
+	const FAISnapshotHeader& Header = Reader.GetHeader();
+	const TArrayView<const FAISnapshotEntity> States = Reader.GetEntities();
+
+	// Entities are matched by the order they joined in
+	if (Header.EntityNum != Entities.Num())
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Snapshot %s holds %d entities, the population has %d"), *SnapshotPath,
+		       Header.EntityNum, Entities.Num());
+		return false;
+	}
+
+	const TArrayView<const float> Neurons = Reader.GetNeurons();
+
+	for (const FAISnapshotEntity& State : States)
+	{
+		const bool bGenomeInside = State.Genome.Offset >= 0 && State.Genome.Num >= 0 &&
+			State.Genome.Offset + State.Genome.Num <= Header.GeneNum;
+		const bool bNeuronsInside = State.NeuronOffset >= 0 && State.NeuronNum >= 0 &&
+			State.NeuronOffset + State.NeuronNum <= Neurons.Num();
+
+		if (!bGenomeInside || !bNeuronsInside)
+		{
+			UE_LOG(LogAIEntity, Warning, TEXT("Snapshot %s is corrupted"), *SnapshotPath);
+			return false;
+		}
+	}
+
+	RunSeed = Header.RunSeed;
+	CurrentStep = Header.Step;
+	GenerationParams.MaxNumberNeurons = Header.MaxNumberNeurons;
+	GenerationEngine.SetGeneration(Header.Generation);
+	GenerationEngine.SetSeed(RunSeed);
+
+	GenomeArena.Load(Reader.GetGenes());
+
+	// Generations recorded after this one are dropped once the lineage reopens at the next turnover
+	Lineage.Close();
+	Interactions.Reset();
+
+	NoveltyArchive.Load(Reader.GetArchive());
+
+	for (int32 i = 0; i < Entities.Num(); i++) Entities[i]->SetGenome(States[i].Genome);
+
+	// Species are clustered on the loaded genomes, the objectives must not see those from before the load
+	GenerationEngine.Sign(Entities, GenomeArena);
+	BuildSpecies();
+
+	// Every brain is rewired, pending ones included
+	PendingWire.Reset();
+	PendingWire.Append(Entities);
+	WirePendingEntities();
+
+	for (int32 i = 0; i < Entities.Num(); i++)
+		Entities[i]->LoadState(States[i], Neurons.Slice(States[i].NeuronOffset, States[i].NeuronNum));
+
+	UE_LOG(LogAIEntity, Log, TEXT("Resumed generation %u step %u from %s"), Header.Generation, Header.Step,
+	       *SnapshotPath);
+
+	return true;
+}
+
+void UAIPopulationSubsystem::RegisterEntity(AAIEntityCharacter* Entity)
+{
+	if (Entities.IsEmpty())
+	{
+		RunSeed = CVarAISeed.GetValueOnGameThread() ? CVarAISeed.GetValueOnGameThread() : FPlatformTime::Cycles();
+		GenerationParams = Entity->GetGenerationParams();
+		GenerationEngine.SetSeed(RunSeed);
+
+		UE_LOG(LogAIEntity, Log, TEXT("Population seed %u"), RunSeed);
+	}
+
+	if (Entities.Contains(Entity)) return;
+
+	// Streams only depend on the seed and the order entities join in
+	Entity->GetRandom().Initialize(HashCombine(RunSeed, Entities.Num()));
+
+	Entity->SetPopulationIndex(Entities.Num());
+	Entities.Add(Entity);
+	bSpeciesStale = true;
+	Traits.Add();
+	PendingWire.Add(Entity);
+	RegisterLikeness(Entity->FAILikenessComponents);
+}
+
+void UAIPopulationSubsystem::UnregisterEntity(AAIEntityCharacter* Entity)
+{
+	const int32 Index = Entities.Find(Entity);
+
+	if (Index != INDEX_NONE)
+	{
+		Entities.RemoveAt(Index);
+		Traits.RemoveAt(Index);
+
+		// Later entities move down one slot
+		for (int32 i = Index; i < Entities.Num(); i++) Entities[i]->SetPopulationIndex(i);
+
+		bSpeciesStale = true;
+	}
+
+	Entity->SetPopulationIndex(INDEX_NONE);
+	PendingWire.Remove(Entity);
+}
+
+void UAIPopulationSubsystem::WirePendingEntities()
+{
+	if (PendingWire.IsEmpty()) return;
+
+	const FAIGenomeArena::FReadScope ReadScope(GenomeArena);
+	TArray<TArrayView<const FAIGene>> Genomes;
+	TArray<FAINeuralNet*> Nets;
+
+	for (AAIEntityCharacter* Entity : PendingWire)
+	{
+		Genomes.Add(Entity->GetGenome());
+		Nets.Add(&Entity->GetNeuralNet());
+	}
+
+	FAIBrain::WireBatch(Genomes, GenerationParams.MaxNumberNeurons, Nets);
+
+	PendingWire.Reset();
+}
+
+void UAIPopulationSubsystem::RegisterLikeness(const FAILikenessComponents& Components)
+{
+	const TArray<FVector>* Locations[3] = {
+		&Components.Locations.InterestedLocations,
+		&Components.Locations.NeutralLocations,
+		&Components.Locations.WaryLocations
+	};
+
+	for (uint8 State = 0; State < 3; State++)
+	{
+		for (const FVector& Location : *Locations[State])
+		{
+			bool bAlreadyInSet;
+			LikenessLocations[State].Add(Location, &bAlreadyInSet);
+			bLikenessIndexDirty |= !bAlreadyInSet;
+		}
+	}
+
+	TArray<FSoftObjectPath> NewPaths;
+	LikenessRegistry.Register(Components.Objects, NewPaths);
+
+	if (NewPaths.IsEmpty()) return;
+
+	// Loaded in the background, entities sense the objects once they are resolved
+	LikenessHandles.Add(StreamableManager.RequestAsyncLoad(
+		NewPaths,
+		FStreamableDelegate::CreateUObject(this, &UAIPopulationSubsystem::OnLikenessLoaded, NewPaths)
+	));
+}
+
+void UAIPopulationSubsystem::OnLikenessLoaded(TArray<FSoftObjectPath> Paths)
+{
+	TArray<TPair<AActor*, EAIEntityState>> Actors;
+	LikenessRegistry.Resolve(Paths, Actors);
+
+	for (const TPair<AActor*, EAIEntityState>& Actor : Actors) LikenessActors.FindOrAdd(Actor.Key, Actor.Value);
+
+	// Place the new objects on the next grid query
+	GridFrame = MAX_uint64;
+}
+
+const FAISpatialGrid& UAIPopulationSubsystem::GetGrid()
+{
+	if (GridFrame == GFrameCounter) return Grid;
+
+	Grid.Reset();
+
+	for (AAIEntityCharacter* Entity : Entities)
+	{
+		if (Entity->IsAlive()) Grid.Add(Entity, Entity->GetActorLocation(), EAIGridKind::Entity);
+	}
+
+	for (const TPair<TWeakObjectPtr<AActor>, EAIEntityState>& Likeness : LikenessActors)
+	{
+		if (AActor* Actor = Likeness.Key.Get())
+			Grid.Add(Actor, Actor->GetActorLocation(), (EAIGridKind)((uint8)Likeness.Value + 1));
+	}
+
+	Grid.Build();
+	GridFrame = GFrameCounter;
+
+	return Grid;
+}
+
+bool UAIPopulationSubsystem::FindNearestLikeness(EAIEntityState State, const FVector& Location, float MaxDistance,
+                                                 FVector2D& OutTarget)
+{
+	PrepareLikenessQueries();
+
+	return FindNearestPreparedLikeness(State, Location, MaxDistance, OutTarget);
+}
+
+void UAIPopulationSubsystem::PrepareLikenessQueries()
+{
+	if (bLikenessIndexDirty)
+	{
+		FAILikenessLocations Merged;
+		Merged.InterestedLocations = LikenessLocations[(uint8)EAIEntityState::Interested].Array();
+		Merged.NeutralLocations = LikenessLocations[(uint8)EAIEntityState::Neutral].Array();
+		Merged.WaryLocations = LikenessLocations[(uint8)EAIEntityState::Wary].Array();
+
+		LikenessIndex.Build(Merged);
+		bLikenessIndexDirty = false;
+	}
+
+	GetGrid();
+}
+
+bool UAIPopulationSubsystem::FindNearestPreparedLikeness(EAIEntityState State, const FVector& Location,
+                                                         float MaxDistance, FVector2D& OutTarget) const
+{
+	// Static locations
+	bool bFound = LikenessIndex.GetTree(State).FindNearest(Location, MaxDistance, OutTarget);
+
+	// Likeness objects, only closer than the static location found
+	const float SearchDistance = bFound ? FVector2D::Distance(FVector2D(Location), OutTarget) : MaxDistance;
+	const EAIGridKind Kind = (EAIGridKind)((uint8)State + 1);
+
+	if (const FAISpatialGridEntry* Entry = Grid.FindNearest(Location, FAISpatialGrid::KindBit(Kind), SearchDistance))
+	{
+		OutTarget = Entry->Location;
+		bFound = true;
+	}
+
+	return bFound;
+}
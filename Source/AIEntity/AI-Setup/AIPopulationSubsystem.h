@@ -0,0 +1,338 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AIDataTypes.h"
+#include "AISpatialGrid.h"
+#include "AILikenessIndex.h"
+#include "AILikenessRegistry.h"
+#include "AISensorRecording.h"
+#include "AIGeneration.h"
+#include "AISnapshot.h"
+#include "AIJournal.h"
+#include "AIGenerationLog.h"
+#include "AIReplay.h"
+#include "AISpecies.h"
+#include "AILineage.h"
+#include "AIInteraction.h"
+#include "AITraits.h"
+#include "AINovelty.h"
+#include "Engine/StreamableManager.h"
+#include "AIPopulationSubsystem.generated.h"
+
+class AAIEntityCharacter;
+
+/** State shared by the whole population of a world */
+UCLASS()
+class AIENTITY_API UAIPopulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** Advance the step every entity takes and turn the generation over at the step limit */
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	/** Step of the current generation the entities are taking */
+	unsigned GetCurrentStep() const { return CurrentStep; }
+
+	/** Generations turned over so far */
+	uint32 GetGeneration() const { return GenerationEngine.GetGeneration(); }
+
+	/** Wire the brains of every entity registered since the last call in one parallel batch */
+	void WirePendingEntities();
+
+	/**
+	 * Write the full simulation state in the background
+	 *
+	 * @param Path File to write, the default snapshot if empty
+	 */
+	void SaveSnapshot(const FString& Path);
+
+	/**
+	 * Resume the simulation from a snapshot of the same population
+	 *
+	 * @param Path File to read, the default snapshot if empty
+	 * @return If the snapshot was applied
+	 */
+	bool LoadSnapshot(const FString& Path);
+
+	/**
+	 * Resume from a snapshot and replay the generations journaled after it
+	 *
+	 * @param Path Snapshot to start from, the default snapshot if empty
+	 * @return If the snapshot was applied
+	 */
+	bool Recover(const FString& Path);
+
+	/**
+	 * Rebuild a generation of a recorded run from its closest keyframe and journal, then fast-forward
+	 * to a step of it without rendering. The world stops recording its own replay from then on.
+	 *
+	 * @param Generation Generation to reach
+	 * @param Step Step of the generation to stop at
+	 * @param Seed Seed of the recorded run, the current run if 0
+	 * @return If the generation was rebuilt
+	 */
+	bool Seek(uint32 Generation, uint32 Step, uint32 Seed);
+
+	/** Species of the current generation, empty until the first turnover or multi-objective selection */
+	const FAISpeciesIndex& GetSpecies() const { return Species; }
+
+	/** Genomes of the whole population */
+	FAIGenomeArena& GetGenomeArena() { return GenomeArena; }
+
+	const FAIGenomeArena& GetGenomeArena() const { return GenomeArena; }
+
+	/**
+	 * Add an entity to the population along with its likeness components
+	 *
+	 * @param Entity Entity that started playing
+	 */
+	void RegisterEntity(AAIEntityCharacter* Entity);
+
+	/**
+	 * Remove an entity from the population
+	 *
+	 * @param Entity Entity that stopped playing
+	 */
+	void UnregisterEntity(AAIEntityCharacter* Entity);
+
+	/** Grid with the entities and likeness objects of the current frame, built on first use */
+	const FAISpatialGrid& GetGrid();
+
+	/**
+	 * Find the nearest likeness target of a state, either a static location or a likeness object
+	 *
+	 * @param State State of the target
+	 * @param Location Where to search from
+	 * @param MaxDistance Targets further away are ignored
+	 * @param OutTarget Location of the nearest target
+	 * @return If a target in range was found
+	 */
+	bool FindNearestLikeness(EAIEntityState State, const FVector& Location, float MaxDistance, FVector2D& OutTarget);
+
+	/**
+	 * State of a traced actor if it is a likeness object
+	 *
+	 * @param Actor Actor to classify
+	 * @param OutState State of the actor
+	 * @return If the actor is a likeness object
+	 */
+	bool ClassifyLikeness(const AActor* Actor, EAIEntityState& OutState) const
+	{
+		return LikenessRegistry.Classify(Actor, OutState);
+	}
+
+	/**
+	 * Queue an interaction to apply once every entity took the step, must run on the game thread
+	 *
+	 * @param Intent Interaction to make
+	 */
+	void EmitInteraction(const FAIInteractionIntent& Intent) { Interactions.Emit(Intent); }
+
+	/** Entities currently in the population */
+	const TArray<TObjectPtr<AAIEntityCharacter>>& GetEntities() const { return Entities; }
+
+	/** Physical traits of the population, indexed like the entities */
+	FAITraitStore& GetTraits() { return Traits; }
+
+	const FAITraitStore& GetTraits() const { return Traits; }
+
+	/** Recorder the brains write their steps to, nullptr when not recording */
+	FAISensorRecorder* GetSensorRecorder() { return SensorRecorder.IsRecording() ? &SensorRecorder : nullptr; }
+
+	/**
+	 * Start recording the brains of the population or stop the current recording
+	 *
+	 * @param Path File to record to, a file in the saved directory if empty
+	 */
+	void ToggleSensorRecording(const FString& Path);
+
+private:
+	/** Seed every entity random stream derives from */
+	uint32 RunSeed = 0;
+
+	/** Rules of the generations, taken from the first registered entity */
+	FAIGenerationParams GenerationParams;
+
+	FAIGenerationEngine GenerationEngine;
+
+	FAIGenomeArena GenomeArena;
+
+	/** Species the current generation is clustered into */
+	FAISpeciesIndex Species;
+
+	/** Entities joined or left since the species were built, their slots no longer line up */
+	bool bSpeciesStale = true;
+
+	unsigned CurrentStep = 0;
+
+	UPROPERTY()
+	TArray<TObjectPtr<AAIEntityCharacter>> Entities;
+
+	TArray<AAIEntityCharacter*> PendingWire;
+
+	/** Resolved likeness objects placed in the world and their state */
+	TMap<TWeakObjectPtr<AActor>, EAIEntityState> LikenessActors;
+
+	FAILikenessRegistry LikenessRegistry;
+
+	/** Streams the likeness objects in without blocking startup */
+	FStreamableManager StreamableManager;
+
+	/** Keeps the loaded likeness objects alive */
+	TArray<TSharedPtr<FStreamableHandle>> LikenessHandles;
+
+	/** Likeness locations of every registered entity, without duplicates */
+	TSet<FVector> LikenessLocations[3];
+
+	FAILikenessIndex LikenessIndex;
+
+	/** Likeness locations changed since the trees were built */
+	bool bLikenessIndexDirty = false;
+
+	FAIInteractionQueue Interactions;
+
+	FAITraitStore Traits;
+
+	FAISpatialGrid Grid;
+
+	/** Frame the grid was built on */
+	uint64 GridFrame = MAX_uint64;
+
+	FAISensorRecorder SensorRecorder;
+
+	FAISnapshotWriter SnapshotWriter;
+
+	/** Journal to start and keyframe to index once the snapshot being written is on disk */
+	FString PendingJournalPath;
+	uint32 PendingGeneration = 0;
+	bool bPendingKeyframe = false;
+
+	/**
+	 * Start the journal and index the keyframe of the snapshot being written once it is on disk
+	 *
+	 * @param bWait Block until the write finished instead of leaving it for a later call
+	 */
+	void CompleteSnapshot(bool bWait);
+
+	/** Turnovers since the last snapshot */
+	FAIJournal Journal;
+
+	FAIReplayIndex ReplayIndex;
+
+	/** A replay was sought, the run is watched instead of recorded */
+	bool bPlayback = false;
+
+	unsigned FastForwardStep = 0;
+
+	bool bFastForwarding = false;
+
+	bool bFixedStep = false;
+
+	/** Time step settings from before the fixed step */
+	bool bSavedUseFixedTimeStep = false;
+
+	double SavedFixedDeltaTime = 0.0;
+
+	/** Record keyframes to the replay of the run */
+	bool IsRecordingReplay() const;
+
+	/** Location of every entity, read on the game thread before any parallel pass needs it */
+	TArray<FVector> Locations;
+
+	/** If each entity is alive and meets the survival criterion */
+	TArray<bool> Surviving;
+
+	/** Judge the survival of every entity into Surviving at its current location */
+	void GatherSurvival();
+
+	TArray<float> Objectives;
+
+	/** Measure the objectives of the generation that is ending, survival must be gathered first */
+	void FillObjectives();
+
+	/** Behaviors of the past generations novelty is measured against */
+	FAINoveltyArchive NoveltyArchive;
+
+	/** Of every entity of the generation that is ending */
+	TArray<FAIBehavior> Behaviors;
+	TArray<float> Novelty;
+	TArray<int32> NoveltyOrder;
+
+	/**
+	 * Score the novelty of the generation that is ending and archive its most novel behaviors, survival
+	 * must be gathered first
+	 */
+	void ScoreNovelty();
+
+	/** The warning that steady state ignores the objectives was logged since they were turned on */
+	bool bObjectivesIgnoredLogged = false;
+
+	/** Cluster the current generation into species and log them */
+	void BuildSpecies();
+
+	/** Log the generation that just started if the generation log is on */
+	void UpdateGenerationLog();
+
+	/** Dead entities and the oldest aged out ones, replaced every step in steady state */
+	TArray<int32> ExpiredSlots;
+	TArray<int32> AgedSlots;
+
+	/** Replace dead and aged out entities with children of fit ones, without a generation barrier */
+	void ReplaceExpired();
+
+	/** Write a keyframe of the run on the keyframe interval or when its journal is missing */
+	void RecordKeyframe();
+
+	/**
+	 * Replay the journal continuing a snapshot that was just loaded
+	 *
+	 * @param SnapshotPath Snapshot the journal continues
+	 * @param LastGeneration Generation to stop at
+	 * @return Generations replayed
+	 */
+	int32 ReplayJournal(const FString& SnapshotPath, uint32 LastGeneration);
+
+	/**
+	 * Take every step on a fixed time step so the movement of a run can be repeated. The step is set on
+	 * FApp and so holds for the whole engine until disabled, which restores the previous settings
+	 *
+	 * @param bEnable If the fixed step is used
+	 */
+	void SetFixedStep(bool bEnable);
+
+	/** Run steps as fast as possible without rendering until a step is reached */
+	void StartFastForward(unsigned Step);
+
+	void StopFastForward();
+
+	FAILineageStore Lineage;
+
+	void GatherGenomes(TArray<TArrayView<const FAIGene>>& OutGenomes) const;
+
+	FAIGenerationLogWriter GenerationLog;
+
+	/** The generation log was opened before in this world */
+	bool bGenerationLogStarted = false;
+
+	/** Fill the columns of the generation that just started and queue them for the generation log */
+	void LogGeneration();
+
+	/** Build the likeness index and grid so likeness queries are read only */
+	void PrepareLikenessQueries();
+
+	/** FindNearestLikeness once the queries are prepared, safe to call from worker threads */
+	bool FindNearestPreparedLikeness(EAIEntityState State, const FVector& Location, float MaxDistance,
+	                                 FVector2D& OutTarget) const;
+
+	/** Merge the likeness components of an entity into the shared index */
+	void RegisterLikeness(const FAILikenessComponents& Components);
+
+	/** Resolve likeness objects once loaded and place the ones in the world in the grid */
+	void OnLikenessLoaded(TArray<FSoftObjectPath> Paths);
+};
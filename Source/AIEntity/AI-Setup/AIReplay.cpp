@@ -0,0 +1,100 @@
+#include "AIReplay.h"
+#include "../AIEntity.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Unique.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FString FAIReplayIndex::RunDirectory(uint32 RunSeed)
+{
+	return FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Runs") / FString::Printf(TEXT("%u"), RunSeed);
+}
+
+FString FAIReplayIndex::KeyframePath(const FString& Directory, uint32 Generation)
+{
+	return Directory / FString::Printf(TEXT("Keyframe_%08u.aisn"), Generation);
+}
+
+FString FAIReplayIndex::IndexPath(const FString& Directory)
+{
+	return Directory / TEXT("Run.aiix");
+}
+
+bool FAIReplayIndex::Open(const FString& Directory, uint32 RunSeed, int32 EntityNum)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*Directory);
+
+	FAIReplayIndexHeader Header;
+	TArray<uint32> Keyframes;
+
+	// A resumed run keeps adding to its own index
+	const bool bContinue = Load(Directory, Header, Keyframes) && Header.RunSeed == RunSeed &&
+		Header.EntityNum == EntityNum;
+
+	FileHandle.Reset(PlatformFile.OpenWrite(*IndexPath(Directory), bContinue));
+
+	if (!FileHandle)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Could not open replay index in %s"), *Directory);
+		return false;
+	}
+
+	if (!bContinue)
+	{
+		Header = FAIReplayIndexHeader();
+		Header.RunSeed = RunSeed;
+		Header.EntityNum = EntityNum;
+
+		FileHandle->Write((const uint8*)&Header, sizeof(Header));
+		FileHandle->Flush();
+	}
+
+	return true;
+}
+
+void FAIReplayIndex::Close()
+{
+	FileHandle.Reset();
+}
+
+void FAIReplayIndex::AddKeyframe(uint32 Generation)
+{
+	if (!FileHandle) return;
+
+	FileHandle->Write((const uint8*)&Generation, sizeof(Generation));
+	FileHandle->Flush();
+}
+
+bool FAIReplayIndex::Load(const FString& Directory, FAIReplayIndexHeader& OutHeader, TArray<uint32>& OutKeyframes)
+{
+	TArray<uint8> Data;
+
+	if (!FFileHelper::LoadFileToArray(Data, *IndexPath(Directory), FILEREAD_Silent) ||
+		Data.Num() < (int32)sizeof(FAIReplayIndexHeader))
+		return false;
+
+	FMemory::Memcpy(&OutHeader, Data.GetData(), sizeof(OutHeader));
+
+	if (!OutHeader.Matches(FAIReplayIndexHeader())) return false;
+
+	// A torn last entry is dropped
+	const int32 Num = (Data.Num() - sizeof(FAIReplayIndexHeader)) / sizeof(uint32);
+
+	OutKeyframes.SetNumUninitialized(Num);
+	FMemory::Memcpy(OutKeyframes.GetData(), Data.GetData() + sizeof(FAIReplayIndexHeader), Num * sizeof(uint32));
+
+	// Keyframes are rewritten when a run is recovered and recorded again
+	OutKeyframes.Sort();
+	OutKeyframes.SetNum(Algo::Unique(OutKeyframes));
+
+	return true;
+}
+
+int32 FAIReplayIndex::FindKeyframe(TArrayView<const uint32> Keyframes, uint32 Generation)
+{
+	return Algo::UpperBound(Keyframes, Generation) - 1;
+}
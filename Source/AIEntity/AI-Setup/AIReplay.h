@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIFileFormat.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+/** Start of a replay index, ties it to the run it indexes */
+struct FAIReplayIndexHeader : FAIFileHeader
+{
+	static constexpr uint32 MagicValue = 0x58524941; // "AIRX"
+
+	static constexpr uint32 VersionValue = 1;
+
+	FAIReplayIndexHeader() : FAIFileHeader{MagicValue, VersionValue} {}
+
+	uint32 RunSeed = 0;
+
+	/** Entities of the population the keyframes hold */
+	int32 EntityNum = 0;
+};
+
+/**
+ * Index over the keyframes of a recorded run: a snapshot every few generations and the journal
+ * continuing each, so any generation is rebuilt from the closest keyframe before it
+ */
+class FAIReplayIndex
+{
+public:
+	~FAIReplayIndex() { Close(); }
+
+	/** Directory a run is recorded in */
+	static FString RunDirectory(uint32 RunSeed);
+
+	/** Snapshot of a keyframe, its journal sits next to it */
+	static FString KeyframePath(const FString& Directory, uint32 Generation);
+
+	/**
+	 * Continue the index of a run or start a new one
+	 *
+	 * @param Directory Directory of the run
+	 * @param RunSeed Seed of the run
+	 * @param EntityNum Entities of the population
+	 * @return If the index could be opened
+	 */
+	bool Open(const FString& Directory, uint32 RunSeed, int32 EntityNum);
+
+	void Close();
+
+	bool IsOpen() const { return FileHandle.IsValid(); }
+
+	/** Add a keyframe once its snapshot is on disk and flush it */
+	void AddKeyframe(uint32 Generation);
+
+	/**
+	 * Read the index of a run
+	 *
+	 * @param Directory Directory of the run
+	 * @param OutHeader Header of the index
+	 * @param OutKeyframes Generation of every keyframe, sorted without duplicates
+	 * @return If the index could be read
+	 */
+	static bool Load(const FString& Directory, FAIReplayIndexHeader& OutHeader, TArray<uint32>& OutKeyframes);
+
+	/**
+	 * Closest keyframe at or before a generation
+	 *
+	 * @param Keyframes Sorted keyframe generations
+	 * @param Generation Generation to reach
+	 * @return Index of the keyframe or INDEX_NONE if every keyframe is later
+	 */
+	static int32 FindKeyframe(TArrayView<const uint32> Keyframes, uint32 Generation);
+
+private:
+	TUniquePtr<IFileHandle> FileHandle;
+
+	static FString IndexPath(const FString& Directory);
+};
@@ -0,0 +1,110 @@
+#include "AISensorCache.h"
+#include "../AIEntity.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarAISensorCache(
+	TEXT("AIEntity.SensorCache"),
+	true,
+	TEXT("Reuse slowly changing sensor values while the entity barely moved")
+);
+
+static FAutoConsoleCommand CmdAISensorCacheStats(
+	TEXT("AIEntity.SensorCacheStats"),
+	TEXT("Log the sensor cache hits and misses per sensor and reset them"),
+	FConsoleCommandDelegate::CreateStatic(&FAISensorCache::DumpStats)
+);
+
+/** Hits and misses per sensor over the whole population, only touched on the game thread */
+static uint64 SensorCacheHits[AISensoryCount];
+static uint64 SensorCacheMisses[AISensoryCount];
+
+const FAISensorCachePolicy& FAISensorCache::GetPolicy(EAISensory Sensor)
+{
+	static const FAISensorCachePolicy NoCache = {0.0f, 0.0f, 0};
+
+	// Static world queries along world axes, rotation does not matter
+	static const FAISensorCachePolicy Boundary = {25.0f, 360.0f, 16};
+
+	// Static world queries along rays relative to the entity
+	static const FAISensorCachePolicy Barrier = {25.0f, 5.0f, 8};
+
+	// Only depends on the location
+	static const FAISensorCachePolicy Location = {5.0f, 360.0f, 16};
+
+	// Static locations and slow moving likeness objects
+	static const FAISensorCachePolicy Likeness = {25.0f, 360.0f, 8};
+
+	switch (Sensor)
+	{
+	case EAISensory::BOUNDARY_DIST:
+	case EAISensory::BOUNDARY_DIST_X:
+	case EAISensory::BOUNDARY_DIST_Y:
+		return Boundary;
+	case EAISensory::BARRIER_FWD:
+	case EAISensory::BARRIER_LR:
+	case EAISensory::LONGPROBE_BAR_FWD:
+		return Barrier;
+	case EAISensory::LOC_X:
+	case EAISensory::LOC_Y:
+		return Location;
+	case EAISensory::INTEREST_DIST:
+	case EAISensory::WARY_DIST:
+		return Likeness;
+	default:
+		return NoCache;
+	}
+}
+
+bool FAISensorCache::Lookup(EAISensory Sensor, const FVector& Location, float Yaw, uint32 Epoch, float& OutValue)
+{
+	const FAISensorCachePolicy& Policy = GetPolicy(Sensor);
+
+	if (Policy.InvalidationDistance <= 0.0f || !CVarAISensorCache.GetValueOnGameThread()) return false;
+
+	const FEntry& Entry = Entries[(uint8)Sensor];
+
+	const bool bValid = Entry.Epoch != MAX_uint32 &&
+		Epoch - Entry.Epoch < Policy.RefreshInterval &&
+		FVector::DistSquared(Location, Entry.Location) < FMath::Square(Policy.InvalidationDistance) &&
+		FMath::Abs(FRotator::NormalizeAxis(Yaw - Entry.Yaw)) < Policy.InvalidationYaw;
+
+	if (!bValid)
+	{
+		SensorCacheMisses[(uint8)Sensor]++;
+		return false;
+	}
+
+	SensorCacheHits[(uint8)Sensor]++;
+	OutValue = Entry.Value;
+	return true;
+}
+
+void FAISensorCache::Store(EAISensory Sensor, const FVector& Location, float Yaw, uint32 Epoch, float Value)
+{
+	if (GetPolicy(Sensor).InvalidationDistance <= 0.0f) return;
+
+	Entries[(uint8)Sensor] = {Location, Yaw, Epoch, Value};
+}
+
+void FAISensorCache::Invalidate()
+{
+	for (FEntry& Entry : Entries) Entry.Epoch = MAX_uint32;
+}
+
+void FAISensorCache::DumpStats()
+{
+	for (EAISensory Sensor : TEnumRange<EAISensory>())
+	{
+		const uint64 Hits = SensorCacheHits[(uint8)Sensor];
+		const uint64 Misses = SensorCacheMisses[(uint8)Sensor];
+
+		if (Hits + Misses == 0) continue;
+
+		UE_LOG(LogAIEntity, Log, TEXT("%s: %llu hits, %llu misses (%.1f%%)"),
+		       *StaticEnum<EAISensory>()->GetNameStringByValue((int64)Sensor), Hits, Misses,
+		       100.0 * Hits / (Hits + Misses));
+	}
+
+	FMemory::Memzero(SensorCacheHits);
+	FMemory::Memzero(SensorCacheMisses);
+}
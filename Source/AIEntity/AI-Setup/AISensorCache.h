@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+
+/** When a cached sensor value has to be sampled again */
+struct FAISensorCachePolicy
+{
+	/** Distance the entity can move before the value is stale, 0 never caches the sensor */
+	float InvalidationDistance;
+
+	/** Yaw change in degrees before the value is stale, rays relative to the entity depend on it */
+	float InvalidationYaw;
+
+	/** Steps before the value is sampled again even if the entity stood still */
+	uint32 RefreshInterval;
+};
+
+/** Last value of each slowly changing sensor, sampled again once the entity moved or turned enough */
+struct FAISensorCache
+{
+	/**
+	 * Get a cached value if it is still valid
+	 *
+	 * @param Sensor Sensor to look up
+	 * @param Location Current location of the entity
+	 * @param Yaw Current yaw of the entity
+	 * @param Epoch Current sensor step of the entity
+	 * @param OutValue Cached value
+	 * @return If the cached value can be used
+	 */
+	bool Lookup(EAISensory Sensor, const FVector& Location, float Yaw, uint32 Epoch, float& OutValue);
+
+	/** Store a value freshly sampled at a location, yaw and sensor step */
+	void Store(EAISensory Sensor, const FVector& Location, float Yaw, uint32 Epoch, float Value);
+
+	void Invalidate();
+
+	/** Cache policy of a sensor */
+	static const FAISensorCachePolicy& GetPolicy(EAISensory Sensor);
+
+	/** Log the hits and misses per sensor of the whole population and reset them */
+	static void DumpStats();
+
+private:
+	/** Last sample of a sensor */
+	struct FEntry
+	{
+		FVector Location;
+		float Yaw;
+		uint32 Epoch = MAX_uint32;
+		float Value;
+	};
+
+	FEntry Entries[AISensoryCount];
+};
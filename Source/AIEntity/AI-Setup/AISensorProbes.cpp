@@ -0,0 +1,260 @@
+#include "AISensorProbes.h"
+#include "../AIEntity.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sensor Probe Trace"), STAT_AIProbeTrace, STATGROUP_AIEntity);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sensor Probe Traces"), STAT_AIProbeTraceCount, STATGROUP_AIEntity);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sensor Probe Reuses"), STAT_AIProbeReuseCount, STATGROUP_AIEntity);
+
+const FHitResult* FAIProbeResult::FirstBarrier() const
+{
+	for (const FHitResult& Hit : Hits)
+	{
+		const UPrimitiveComponent* Component = Hit.GetComponent();
+
+		if (Component && Component->GetCollisionObjectType() == ECC_WorldStatic) return &Hit;
+	}
+
+	return nullptr;
+}
+
+void FAIProbeBundle::Init(AActor* InOwner, float InRange)
+{
+	Owner = InOwner;
+	Range = InRange;
+
+	QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(AIProbe), false, Owner);
+
+	// Static geometry for barriers and boundaries, pawns and dynamic actors for population
+	ObjectParams = FCollisionObjectQueryParams();
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+}
+
+const FAIProbeResult& FAIProbeBundle::Probe(EAIProbeRay Ray, uint32 Epoch)
+{
+	FAIProbeResult& Result = Results[(uint8)Ray];
+
+	RequestedMask |= 1u << (uint8)Ray;
+
+	// Already traced this step, every other sensor reuses the hits
+	// Hits from the previous frame are good enough when latency tolerant, only trace if nothing arrived yet
+	if (Result.Epoch == Epoch || (bLatencyTolerant && Result.Epoch != MAX_uint32))
+	{
+		INC_DWORD_STAT(STAT_AIProbeReuseCount);
+		return Result;
+	}
+
+	TraceSync(Ray, Result);
+	Result.Epoch = Epoch;
+
+	return Result;
+}
+
+void FAIProbeBundle::ProbeSegment(EAIProbeRay Ray, FVector& OutStart, FVector& OutEnd) const
+{
+	OutStart = Owner->GetActorLocation();
+	OutEnd = Ray == EAIProbeRay::Neighborhood
+		         ? OutStart
+		         : OutStart + RayDirection(Ray, Owner->GetActorRotation()) * Range;
+}
+
+void FAIProbeBundle::TraceSync(EAIProbeRay Ray, FAIProbeResult& Result) const
+{
+	ProbeSegment(Ray, Result.Start, Result.End);
+	TraceSegment(Ray, Result);
+}
+
+void FAIProbeBundle::TraceSegment(EAIProbeRay Ray, FAIProbeResult& Result) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIProbeTrace);
+	INC_DWORD_STAT(STAT_AIProbeTraceCount);
+
+	UWorld* World = Owner->GetWorld();
+
+	// Keeps the capacity of the previous step, no allocation once warmed up
+	Result.Hits.Reset();
+
+	if (Ray == EAIProbeRay::Neighborhood)
+	{
+		World->SweepMultiByChannel(
+			Result.Hits,
+			Result.Start,
+			Result.End,
+			FQuat::Identity,
+			ECC_Pawn,
+			FCollisionShape::MakeSphere(NeighborhoodRadius),
+			QueryParams
+		);
+		return;
+	}
+
+	World->LineTraceMultiByObjectType(Result.Hits, Result.Start, Result.End, ObjectParams, QueryParams);
+}
+
+void FAIProbeBundle::SubmitAsync(uint32 Epoch)
+{
+	for (uint8 Ray = 0; Ray < (uint8)EAIProbeRay::Count; Ray++)
+	{
+		if (!(RequestedMask & (1u << Ray))) continue;
+
+		ProbeSegment((EAIProbeRay)Ray, PendingStart[Ray], PendingEnd[Ray]);
+		PendingEpoch[Ray] = Epoch;
+
+		TraceAsync((EAIProbeRay)Ray);
+	}
+
+	RequestedMask = 0;
+}
+
+void FAIProbeBundle::TraceAsync(EAIProbeRay Ray)
+{
+	UWorld* World = Owner->GetWorld();
+
+	const FVector& Start = PendingStart[(uint8)Ray];
+	const FVector& End = PendingEnd[(uint8)Ray];
+
+	if (Ray == EAIProbeRay::Neighborhood)
+	{
+		Pending[(uint8)Ray] = World->AsyncSweepByChannel(
+			EAsyncTraceType::Multi,
+			Start,
+			End,
+			FQuat::Identity,
+			ECC_Pawn,
+			FCollisionShape::MakeSphere(NeighborhoodRadius),
+			QueryParams
+		);
+	}
+	else
+	{
+		Pending[(uint8)Ray] = World->AsyncLineTraceByObjectType(
+			EAsyncTraceType::Multi,
+			Start,
+			End,
+			ObjectParams,
+			QueryParams
+		);
+	}
+}
+
+void FAIProbeBundle::CollectAsync()
+{
+	UWorld* World = Owner->GetWorld();
+
+	for (uint8 Ray = 0; Ray < (uint8)EAIProbeRay::Count; Ray++)
+	{
+		if (!Pending[Ray].IsValid()) continue;
+
+		// Results of last frame, unfinished traces keep the previous hits
+		if (World->QueryTraceData(Pending[Ray], TraceDatum))
+		{
+			// Copied so both the hits and the datum keep their capacity between frames
+			Results[Ray].Hits.Reset();
+			Results[Ray].Hits.Append(TraceDatum.OutHits);
+			Results[Ray].Start = PendingStart[Ray];
+			Results[Ray].End = PendingEnd[Ray];
+			Results[Ray].Epoch = PendingEpoch[Ray];
+		}
+
+		Pending[Ray].Invalidate();
+	}
+}
+
+void FAIProbeBundle::Invalidate()
+{
+	for (uint8 Ray = 0; Ray < (uint8)EAIProbeRay::Count; Ray++)
+	{
+		Results[Ray].Hits.Reset();
+		Results[Ray].Epoch = MAX_uint32;
+		Pending[Ray].Invalidate();
+	}
+
+	RequestedMask = 0;
+}
+
+void FAIProbeBundle::Save(FAIProbeState& Out) const
+{
+	for (uint8 Ray = 0; Ray < (uint8)EAIProbeRay::Count; Ray++)
+	{
+		Out.Results[Ray].Start = Results[Ray].Start;
+		Out.Results[Ray].End = Results[Ray].End;
+		Out.Results[Ray].Epoch = Results[Ray].Epoch;
+
+		Out.Pending[Ray] = FAIProbeSegment();
+
+		if (Pending[Ray].IsValid())
+		{
+			Out.Pending[Ray].Start = PendingStart[Ray];
+			Out.Pending[Ray].End = PendingEnd[Ray];
+			Out.Pending[Ray].Epoch = PendingEpoch[Ray];
+		}
+	}
+}
+
+void FAIProbeBundle::Load(const FAIProbeState& State)
+{
+	Invalidate();
+
+	// Without latency tolerance hits are never read past the step they were traced in
+	if (!bLatencyTolerant) return;
+
+	for (uint8 Ray = 0; Ray < (uint8)EAIProbeRay::Count; Ray++)
+	{
+		const FAIProbeSegment& Held = State.Results[Ray];
+
+		if (Held.Epoch != MAX_uint32)
+		{
+			Results[Ray].Start = Held.Start;
+			Results[Ray].End = Held.End;
+			Results[Ray].Epoch = Held.Epoch;
+			TraceSegment((EAIProbeRay)Ray, Results[Ray]);
+		}
+
+		const FAIProbeSegment& InFlight = State.Pending[Ray];
+
+		if (InFlight.Epoch != MAX_uint32)
+		{
+			PendingStart[Ray] = InFlight.Start;
+			PendingEnd[Ray] = InFlight.End;
+			PendingEpoch[Ray] = InFlight.Epoch;
+			TraceAsync((EAIProbeRay)Ray);
+		}
+	}
+}
+
+void FAIProbeBundle::DrawDebug() const
+{
+	UWorld* World = Owner->GetWorld();
+
+	for (uint8 Ray = 0; Ray < (uint8)EAIProbeRay::Count; Ray++)
+	{
+		const FAIProbeResult& Result = Results[Ray];
+
+		if (Result.Epoch == MAX_uint32) continue;
+
+		if ((EAIProbeRay)Ray == EAIProbeRay::Neighborhood)
+			DrawDebugSphere(World, Result.Start, NeighborhoodRadius, 12, FColor::Red);
+		else
+			DrawDebugLine(World, Result.Start, Result.End, FColor::Red);
+
+		for (const FHitResult& Hit : Result.Hits) DrawDebugPoint(World, Hit.ImpactPoint, 10.0f, FColor::Green);
+	}
+}
+
+FVector FAIProbeBundle::RayDirection(EAIProbeRay Ray, const FRotator& Rotation)
+{
+	switch (Ray)
+	{
+	case EAIProbeRay::Forward: return Rotation.Vector();
+	case EAIProbeRay::Left: return FRotator(0, -90, 0).RotateVector(Rotation.Vector());
+	case EAIProbeRay::Right: return FRotator(0, 90, 0).RotateVector(Rotation.Vector());
+	case EAIProbeRay::North: return FVector(0, 1, 0); // North (Y+)
+	case EAIProbeRay::South: return FVector(0, -1, 0); // South (Y-)
+	case EAIProbeRay::East: return FVector(1, 0, 0); // East (X+)
+	case EAIProbeRay::West: return FVector(-1, 0, 0); // West (X-)
+	default: return FVector::ZeroVector;
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "CollisionQueryParams.h"
+#include "WorldCollision.h"
+
+/** Distinct probes an entity casts while sensing, every sensor reading the same probe shares its hits */
+enum class EAIProbeRay : uint8
+{
+	Forward,
+	Left,
+	Right,
+	North,
+	South,
+	East,
+	West,
+	Neighborhood, // Sphere around the entity for population density
+	Count
+};
+
+/** Hits of a single probe, traced at most once per step */
+struct FAIProbeResult
+{
+	/** Every object hit along the probe, sorted by distance */
+	TArray<FHitResult> Hits;
+
+	FVector Start = FVector::ZeroVector;
+
+	FVector End = FVector::ZeroVector;
+
+	/** Sensor step the hits belong to */
+	uint32 Epoch = MAX_uint32;
+
+	/** Nearest static geometry along the probe, nullptr if the probe is clear */
+	const FHitResult* FirstBarrier() const;
+};
+
+/** Segment a probe was cast along and the sensor step it belongs to, MAX_uint32 if there is none */
+struct FAIProbeSegment
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	uint32 Epoch = MAX_uint32;
+};
+
+/** Probes of an entity as stored in a snapshot, the hits are traced again along the same segments */
+struct FAIProbeState
+{
+	FAIProbeSegment Results[(uint8)EAIProbeRay::Count];
+	FAIProbeSegment Pending[(uint8)EAIProbeRay::Count];
+};
+
+/**
+ * Casts each distinct ray of an entity once per step and keeps the hits for every sensor reading it.
+ * In latency tolerant mode the probes are traced async and read one step late.
+ */
+struct FAIProbeBundle
+{
+	/** Read probes from the async traces of the previous frame instead of tracing on demand */
+	bool bLatencyTolerant = false;
+
+	static constexpr float NeighborhoodRadius = 500.0f;
+
+	/** Build the cached query params of the owner */
+	void Init(AActor* InOwner, float InRange);
+
+	/**
+	 * Get the hits of a probe for the current step, tracing it if it was not traced yet
+	 *
+	 * @param Ray Probe to query
+	 * @param Epoch Current sensor step of the entity
+	 */
+	const FAIProbeResult& Probe(EAIProbeRay Ray, uint32 Epoch);
+
+	/** Queue async traces for every probe read since the last submit */
+	void SubmitAsync(uint32 Epoch);
+
+	void CollectAsync();
+
+	/** Forget every hit and drop the async traces in flight, the next reads trace afresh */
+	void Invalidate();
+
+	/** Segments of the hits held and of the async traces in flight */
+	void Save(FAIProbeState& Out) const;
+
+	/** Trace the held hits again and resubmit the async traces that were in flight, only when latency tolerant */
+	void Load(const FAIProbeState& State);
+
+	/** Draw every probe traced so far with its hits */
+	void DrawDebug() const;
+
+	/** Hits of a probe as last traced or collected, without tracing it */
+	const FAIProbeResult& GetResult(EAIProbeRay Ray) const { return Results[(uint8)Ray]; }
+
+	/** Direction of a ray relative to the owner rotation */
+	static FVector RayDirection(EAIProbeRay Ray, const FRotator& Rotation);
+
+private:
+	AActor* Owner = nullptr;
+
+	float Range = 0.0f;
+
+	/** Ignores the owner, built once */
+	FCollisionQueryParams QueryParams;
+
+	/** Static, dynamic and pawn object types, built once */
+	FCollisionObjectQueryParams ObjectParams;
+
+	FAIProbeResult Results[(uint8)EAIProbeRay::Count];
+
+	FTraceHandle Pending[(uint8)EAIProbeRay::Count];
+
+	uint32 PendingEpoch[(uint8)EAIProbeRay::Count];
+
+	/** Kept apart so the results still match their hits */
+	FVector PendingStart[(uint8)EAIProbeRay::Count];
+	FVector PendingEnd[(uint8)EAIProbeRay::Count];
+
+	/** Probes read since the last submit, one bit per probe */
+	uint32 RequestedMask = 0;
+
+	/** Trace results are copied out through this, reused every frame */
+	FTraceDatum TraceDatum;
+
+	/** Start and end of a probe from the current owner transform */
+	void ProbeSegment(EAIProbeRay Ray, FVector& OutStart, FVector& OutEnd) const;
+
+	/** Trace a probe on the game thread */
+	void TraceSync(EAIProbeRay Ray, FAIProbeResult& Result) const;
+
+	/** Trace a probe on the game thread along the segment already in the result */
+	void TraceSegment(EAIProbeRay Ray, FAIProbeResult& Result) const;
+
+	/** Queue an async trace of a probe along its pending segment */
+	void TraceAsync(EAIProbeRay Ray);
+};
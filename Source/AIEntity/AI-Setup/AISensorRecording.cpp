@@ -0,0 +1,232 @@
+#include "AISensorRecording.h"
+#include "AIBrain.h"
+#include "../AIEntity.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+bool FAISensorRecorder::Open(const FString& InPath)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(InPath));
+
+	FileHandle.Reset(PlatformFile.OpenWrite(*InPath));
+
+	if (!FileHandle)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Could not open sensor recording %s"), *InPath);
+		return false;
+	}
+
+	Path = InPath;
+
+	Append(FAISensorRecordingHeader());
+
+	return true;
+}
+
+void FAISensorRecorder::Close()
+{
+	if (!FileHandle) return;
+
+	Flush();
+	FileHandle.Reset();
+	Written.Reset();
+	WrittenGenomes.Reset();
+}
+
+void FAISensorRecorder::Flush()
+{
+	if (Buffer.IsEmpty()) return;
+
+	FileHandle->Write(Buffer.GetData(), Buffer.Num());
+	Buffer.Reset();
+}
+
+void FAISensorRecorder::Quantize(FAISensorValues& Sensors)
+{
+	for (float& Value : Sensors.Values) Value = FMath::RoundToInt32(FMath::Clamp(Value, 0.0f, 1.0f) * 255.0f) / 255.0f;
+}
+
+void FAISensorRecorder::PrepareStep(uint32 EntityId, TArrayView<const FAIGene> Genome, uint32 MaxNumberNeurons,
+                                    const FAINeuralNet& Net)
+{
+	bool bAlreadyWritten;
+	Written.Add(EntityId, &bAlreadyWritten);
+
+	if (bAlreadyWritten) return;
+
+	// Most of a population shares a few genomes after some generations, each is stored once
+	const uint64 GenomeHash = CityHash64WithSeed((const char*)Genome.GetData(), Genome.Num() * sizeof(FAIGene),
+	                                             MaxNumberNeurons);
+
+	WrittenGenomes.Add(GenomeHash, &bAlreadyWritten);
+
+	if (!bAlreadyWritten)
+	{
+		Append(EBlock::Genome);
+		Append(GenomeHash);
+		Append(MaxNumberNeurons);
+		Append((uint32)Genome.Num());
+
+		for (const FAIGene& Gene : Genome) Append(Gene.ToWord());
+	}
+
+	Append(EBlock::Wire);
+	Append(EntityId);
+	Append(GenomeHash);
+
+	// Neurons keep their output between steps, the replay starts from the same state
+	Append((uint32)Net.Neurons.Num());
+
+	for (const FAINeuralNet::Neuron& Neuron : Net.Neurons) Append(Neuron.Output);
+}
+
+void FAISensorRecorder::RecordStep(uint32 EntityId, uint32 Step, const FAISensorValues& Sensors,
+                                   const FAIActionLevels& Levels)
+{
+	Append(EBlock::Step);
+	Append(EntityId);
+	Append(Step);
+
+	for (float Value : Sensors.Values) Append((uint8)FMath::RoundToInt32(Value * 255.0f));
+
+	Buffer.Append((const uint8*)Levels.Levels, sizeof(Levels.Levels));
+
+	if (Buffer.Num() >= FlushSize) Flush();
+}
+
+bool FAISensorReplay::Run(const FString& Path, FAISensorReplayReport& OutReport)
+{
+	OutReport = FAISensorReplayReport();
+
+	FAIFileView File;
+
+	return File.Open(Path) && RunBuffer(File.GetData(), File.GetSize(), OutReport);
+}
+
+bool FAISensorReplay::RunBuffer(const uint8* Data, int64 Size, FAISensorReplayReport& OutReport)
+{
+	int64 Cursor = 0;
+
+	auto Read = [&](void* Out, int64 Bytes)
+	{
+		if (Cursor + Bytes > Size) return false;
+
+		FMemory::Memcpy(Out, Data + Cursor, Bytes);
+		Cursor += Bytes;
+		return true;
+	};
+
+	FAISensorRecordingHeader Header;
+
+	if (!Read(&Header, sizeof(Header)) || !Header.Matches(FAISensorRecordingHeader())) return false;
+
+	if (Header.SensorNum != AISensoryCount || Header.ActionNum != AIActionsCount)
+	{
+		UE_LOG(LogAIEntity, Warning, TEXT("Sensor recording does not match the current sensors and actions"));
+		return false;
+	}
+
+	// Genomes are referenced by hash from the wire blocks
+	struct FRecordedGenome
+	{
+		uint32 MaxNumberNeurons;
+		TArray<FAIGene> Genes;
+	};
+
+	TMap<uint64, FRecordedGenome> Genomes;
+	TMap<uint32, FAINeuralNet> Brains;
+
+	while (Cursor < Size)
+	{
+		FAISensorRecorder::EBlock Block;
+
+		if (!Read(&Block, sizeof(Block))) return false;
+
+		if (Block == FAISensorRecorder::EBlock::Genome)
+		{
+			uint64 GenomeHash;
+			uint32 GeneCount;
+			FRecordedGenome Genome;
+
+			if (!Read(&GenomeHash, sizeof(uint64)) || !Read(&Genome.MaxNumberNeurons, sizeof(uint32)) ||
+				!Read(&GeneCount, sizeof(uint32)) || Cursor + (int64)GeneCount * sizeof(uint32) > Size)
+				return false;
+
+			Genome.Genes.SetNumUninitialized(GeneCount);
+
+			for (FAIGene& Gene : Genome.Genes)
+			{
+				uint32 Word;
+				Read(&Word, sizeof(Word));
+
+				Gene = FAIGene::FromWord(Word);
+			}
+
+			Genomes.Add(GenomeHash, MoveTemp(Genome));
+			OutReport.Genomes++;
+			continue;
+		}
+
+		uint32 EntityId;
+
+		if (!Read(&EntityId, sizeof(EntityId))) return false;
+
+		if (Block == FAISensorRecorder::EBlock::Wire)
+		{
+			uint64 GenomeHash;
+			uint32 NeuronCount;
+
+			if (!Read(&GenomeHash, sizeof(uint64))) return false;
+
+			const FRecordedGenome* Genome = Genomes.Find(GenomeHash);
+			if (!Genome) return false;
+
+			FAINeuralNet& Net = Brains.FindOrAdd(EntityId);
+
+			const double WireStart = FPlatformTime::Seconds();
+			FAIBrain::Wire(Genome->Genes, Genome->MaxNumberNeurons, Net);
+			OutReport.WireSeconds += FPlatformTime::Seconds() - WireStart;
+
+			if (!Read(&NeuronCount, sizeof(uint32)) || NeuronCount != (uint32)Net.Neurons.Num()) return false;
+
+			for (FAINeuralNet::Neuron& Neuron : Net.Neurons)
+			{
+				if (!Read(&Neuron.Output, sizeof(float))) return false;
+			}
+
+			OutReport.Wirings++;
+		}
+		else if (Block == FAISensorRecorder::EBlock::Step)
+		{
+			uint32 Step;
+			uint8 Quantized[AISensoryCount];
+			FAIActionLevels Recorded, Levels;
+			FAISensorValues Sensors;
+
+			if (!Read(&Step, sizeof(Step)) || !Read(Quantized, sizeof(Quantized)) ||
+				!Read(Recorded.Levels, sizeof(Recorded.Levels)))
+				return false;
+
+			FAINeuralNet* Net = Brains.Find(EntityId);
+			if (!Net) return false;
+
+			for (int32 i = 0; i < AISensoryCount; i++) Sensors.Values[i] = Quantized[i] / 255.0f;
+
+			const double EvaluateStart = FPlatformTime::Seconds();
+			FAIBrain::Evaluate(*Net, Sensors, Levels);
+			OutReport.EvaluateSeconds += FPlatformTime::Seconds() - EvaluateStart;
+
+			if (FMemory::Memcmp(Levels.Levels, Recorded.Levels, sizeof(Levels.Levels)) != 0) OutReport.Mismatches++;
+
+			OutReport.Steps++;
+		}
+		else return false;
+	}
+
+	return true;
+}
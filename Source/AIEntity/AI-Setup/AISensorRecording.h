@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+#include "AIFileFormat.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+/** Start of a sensor recording, the blocks follow */
+struct FAISensorRecordingHeader : FAIFileHeader
+{
+	static constexpr uint32 MagicValue = 0x52534941; // "AISR"
+
+	static constexpr uint32 VersionValue = 3;
+
+	FAISensorRecordingHeader() : FAIFileHeader{MagicValue, VersionValue} {}
+
+	/** Sensor and action counts the recorded genes address */
+	uint8 SensorNum = AISensoryCount;
+	uint8 ActionNum = AIActionsCount;
+
+	uint16 Reserved = 0;
+};
+
+/**
+ * Appends the sensor vectors and action levels of every evaluated brain to a compact binary stream
+ * that can be replayed without the world. Sensors are quantized to 8 bits so replays are exact.
+ */
+class FAISensorRecorder
+{
+public:
+	enum class EBlock : uint8
+	{
+		Genome,
+		Step,
+		Wire
+	};
+
+	~FAISensorRecorder() { Close(); }
+
+	/** Start a new recording, replacing the file */
+	bool Open(const FString& Path);
+
+	void Close();
+
+	bool IsRecording() const { return FileHandle.IsValid(); }
+
+	const FString& GetPath() const { return Path; }
+
+	/** Snap the sensor values to what is stored */
+	static void Quantize(FAISensorValues& Sensors);
+
+	/**
+	 * Write the wire block of an entity if it was not written since it was last wired, along with the
+	 * genome block if the genome was not recorded yet, must be called before the brain is evaluated
+	 *
+	 * @param EntityId Identifier of the entity
+	 * @param Genome Genome the brain is wired from
+	 * @param MaxNumberNeurons Neurons the genes are folded into
+	 * @param Net Wired brain with the neuron outputs before the step
+	 */
+	void PrepareStep(uint32 EntityId, TArrayView<const FAIGene> Genome, uint32 MaxNumberNeurons,
+	                 const FAINeuralNet& Net);
+
+	/**
+	 * Write the step block of an entity
+	 *
+	 * @param EntityId Identifier of the entity
+	 * @param Step Sensor step of the entity
+	 * @param Sensors Quantized sensor values fed to the brain
+	 * @param Levels Action levels the brain produced
+	 */
+	void RecordStep(uint32 EntityId, uint32 Step, const FAISensorValues& Sensors, const FAIActionLevels& Levels);
+
+	/** Write a new wire block for the entity on its next step */
+	void ForgetEntity(uint32 EntityId) { Written.Remove(EntityId); }
+
+private:
+	/** Bytes buffered before they are written out */
+	static constexpr int32 FlushSize = 64 * 1024;
+
+	TUniquePtr<IFileHandle> FileHandle;
+
+	FString Path;
+
+	TArray<uint8> Buffer;
+
+	TSet<uint32> Written;
+
+	TSet<uint64> WrittenGenomes;
+
+	template <typename T>
+	void Append(const T& Value) { Buffer.Append((const uint8*)&Value, sizeof(T)); }
+
+	void Flush();
+};
+
+/** Outcome of replaying a recording */
+struct FAISensorReplayReport
+{
+	int32 Genomes = 0;
+
+	/** Brains wired, an entity is wired again whenever its genome changes */
+	int32 Wirings = 0;
+
+	int32 Steps = 0;
+
+	/** Steps whose action levels differ from the recorded ones */
+	int32 Mismatches = 0;
+
+	double WireSeconds = 0.0;
+
+	double EvaluateSeconds = 0.0;
+};
+
+/** Replays a sensor recording through the brains offline */
+struct FAISensorReplay
+{
+	/**
+	 * Rewire every recorded genome and evaluate every recorded step
+	 *
+	 * @param Path Recording to replay
+	 * @param OutReport Counts and timings of the replay
+	 * @return If the recording could be read
+	 */
+	static bool Run(const FString& Path, FAISensorReplayReport& OutReport);
+
+private:
+	static bool RunBuffer(const uint8* Data, int64 Size, FAISensorReplayReport& OutReport);
+};
@@ -0,0 +1,111 @@
+#include "AISnapshot.h"
+#include "../AIEntity.h"
+#include "Async/Async.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/** Sections start on a boundary every plain struct can be read from in place */
+static uint64 AlignSection(uint64 Offset)
+{
+	return Align(Offset, 16);
+}
+
+void FAISnapshotWriter::Begin(const FAISnapshotHeader& InHeader)
+{
+	// The previous write still reads the buffer
+	Wait();
+
+	FAISnapshotHeader Layout = InHeader;
+	Layout.Magic = FAISnapshotHeader::MagicValue;
+	Layout.Version = FAISnapshotHeader::VersionValue;
+	Layout.SensorNum = AISensoryCount;
+	Layout.ActionNum = AIActionsCount;
+
+	Layout.EntitiesOffset = AlignSection(sizeof(FAISnapshotHeader));
+	Layout.GenesOffset = AlignSection(Layout.EntitiesOffset + Layout.EntityNum * sizeof(FAISnapshotEntity));
+	Layout.NeuronsOffset = AlignSection(Layout.GenesOffset + Layout.GeneNum * sizeof(FAIGene));
+	Layout.PheromonesOffset = AlignSection(Layout.NeuronsOffset + Layout.NeuronNum * sizeof(float));
+	Layout.ArchiveOffset = AlignSection(Layout.PheromonesOffset + Layout.PheromoneNum * sizeof(float));
+
+	Buffer.SetNumZeroed(Layout.ArchiveOffset + Layout.ArchiveNum * sizeof(FAIBehavior));
+	FMemory::Memcpy(Buffer.GetData(), &Layout, sizeof(Layout));
+}
+
+TArrayView<FAISnapshotEntity> FAISnapshotWriter::GetEntities()
+{
+	return Section<FAISnapshotEntity>(Header().EntitiesOffset, Header().EntityNum);
+}
+
+TArrayView<FAIGene> FAISnapshotWriter::GetGenes()
+{
+	return Section<FAIGene>(Header().GenesOffset, Header().GeneNum);
+}
+
+TArrayView<float> FAISnapshotWriter::GetNeurons()
+{
+	return Section<float>(Header().NeuronsOffset, Header().NeuronNum);
+}
+
+TArrayView<float> FAISnapshotWriter::GetPheromones()
+{
+	return Section<float>(Header().PheromonesOffset, Header().PheromoneNum);
+}
+
+TArrayView<FAIBehavior> FAISnapshotWriter::GetArchive()
+{
+	return Section<FAIBehavior>(Header().ArchiveOffset, Header().ArchiveNum);
+}
+
+void FAISnapshotWriter::WriteAsync(const FString& Path)
+{
+	Pending = Async(EAsyncExecution::ThreadPool, [this, Path]()
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		const FString TempPath = Path + TEXT(".tmp");
+
+		PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+		if (!FFileHelper::SaveArrayToFile(Buffer, *TempPath))
+		{
+			UE_LOG(LogAIEntity, Warning, TEXT("Could not write snapshot %s"), *TempPath);
+			return false;
+		}
+
+		PlatformFile.DeleteFile(*Path);
+
+		if (!PlatformFile.MoveFile(*Path, *TempPath))
+		{
+			UE_LOG(LogAIEntity, Warning, TEXT("Could not move snapshot to %s"), *Path);
+			return false;
+		}
+
+		return true;
+	});
+}
+
+bool FAISnapshotWriter::Wait()
+{
+	return !Pending.IsValid() || Pending.Get();
+}
+
+bool FAISnapshotReader::Open(const FString& Path)
+{
+	if (!File.Open(Path) || !File.GetHeader<FAISnapshotHeader>()) return false;
+
+	const FAISnapshotHeader& Header = GetHeader();
+
+	if (Header.SensorNum != AISensoryCount || Header.ActionNum != AIActionsCount) return false;
+
+	// Every section has to be inside the file
+	auto Fits = [this](uint64 Offset, int32 Num, SIZE_T Stride)
+	{
+		return Num >= 0 && Offset % 16 == 0 && Offset + Num * Stride <= (uint64)File.GetSize();
+	};
+
+	return Fits(Header.EntitiesOffset, Header.EntityNum, sizeof(FAISnapshotEntity)) &&
+		Fits(Header.GenesOffset, Header.GeneNum, sizeof(FAIGene)) &&
+		Fits(Header.NeuronsOffset, Header.NeuronNum, sizeof(float)) &&
+		Fits(Header.PheromonesOffset, Header.PheromoneNum, sizeof(float)) &&
+		Fits(Header.ArchiveOffset, Header.ArchiveNum, sizeof(FAIBehavior));
+}
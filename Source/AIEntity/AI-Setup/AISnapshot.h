@@ -0,0 +1,184 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIDataTypes.h"
+#include "AIFileFormat.h"
+#include "AINovelty.h"
+#include "AISensorCache.h"
+#include "AISensorProbes.h"
+#include "../Movement-Setup/ActionSetup.h"
+#include "Async/Future.h"
+
+/** Start of a snapshot file, every section is an array of plain structs at a 16-byte aligned offset */
+struct FAISnapshotHeader : FAIFileHeader
+{
+	static constexpr uint32 MagicValue = 0x4E534941; // "AISN"
+
+	static constexpr uint32 VersionValue = 8;
+
+	FAISnapshotHeader() : FAIFileHeader{MagicValue, VersionValue} {}
+
+	/** Genes address sensors and actions modulo their counts, genomes only mean the same under the same counts */
+	uint32 SensorNum = AISensoryCount;
+	uint32 ActionNum = AIActionsCount;
+
+	uint32 RunSeed = 0;
+	uint32 Generation = 0;
+	uint32 Step = 0;
+	uint32 MaxNumberNeurons = 0;
+
+	int32 EntityNum = 0;
+	int32 GeneNum = 0;
+	int32 NeuronNum = 0;
+	int32 PheromoneNum = 0;
+
+	/** Behaviors of the novelty archive */
+	int32 ArchiveNum = 0;
+
+	uint64 EntitiesOffset = 0;
+	uint64 GenesOffset = 0;
+	uint64 NeuronsOffset = 0;
+	uint64 PheromonesOffset = 0;
+	uint64 ArchiveOffset = 0;
+};
+
+/** State of one entity as stored in a snapshot, everything its next steps depend on */
+struct FAISnapshotEntity
+{
+	FVector Location;
+	FRotator Rotation;
+	FRotator ControlRotation;
+	FVector Velocity;
+
+	/** Movement values the character carries from one frame to the next */
+	FActionMotion Motion;
+	uint32 MovementMode;
+
+	FVector StartLocation;
+	FRotator StartRotation;
+	FVector KnownSpaceMin;
+	FVector KnownSpaceMax;
+	FVector LastMovementLocation;
+	FRotator LastMovementRotation;
+
+	FAIGenomeSpan Genome;
+
+	int32 NeuronOffset;
+	int32 NeuronNum;
+
+	uint32 Alive;
+	uint32 Age;
+	uint32 OscillationPeriod;
+	uint32 LongProbesDistance;
+	uint32 SuccessRate;
+	uint32 SensorEpoch;
+	float Responsiveness;
+
+	float Health;
+	float Stamina;
+	float Speed;
+
+	/** What the entity did this generation so far */
+	int32 TouchCount;
+	int32 PheromoneSteps;
+	FVector2D ExploredMin;
+	FVector2D ExploredMax;
+	uint32 bExplored;
+	FAIBehaviorAccumulator Behavior;
+
+	/** Sensor values the next steps may still reuse instead of sampling again */
+	FAISensorCache SensorCache;
+	FAIProbeState Probes;
+
+	int32 RandomSeed;
+};
+
+static_assert(TIsTriviallyCopyable<FAISnapshotEntity>::Value, "Snapshot entities are copied as raw memory");
+
+/** Builds a snapshot in memory on the game thread and writes it out on a background thread */
+class FAISnapshotWriter
+{
+public:
+	~FAISnapshotWriter() { Wait(); }
+
+	/**
+	 * Lay out a snapshot, the sections are filled through the returned views
+	 *
+	 * @param Header Run state, the counts size the sections and the offsets are filled in
+	 */
+	void Begin(const FAISnapshotHeader& Header);
+
+	TArrayView<FAISnapshotEntity> GetEntities();
+	TArrayView<FAIGene> GetGenes();
+	TArrayView<float> GetNeurons();
+	TArrayView<float> GetPheromones();
+	TArrayView<FAIBehavior> GetArchive();
+
+	/** Write the snapshot in the background, waits for the previous write first */
+	void WriteAsync(const FString& Path);
+
+	/** Block until the last write finished and return if the snapshot reached its destination */
+	bool Wait();
+
+	/** The last write is still running, Wait would block */
+	bool IsWriting() const { return Pending.IsValid() && !Pending.IsReady(); }
+
+private:
+	TArray<uint8> Buffer;
+
+	TFuture<bool> Pending;
+
+	const FAISnapshotHeader& Header() const { return *(const FAISnapshotHeader*)Buffer.GetData(); }
+
+	template <typename T>
+	TArrayView<T> Section(uint64 Offset, int32 Num) { return TArrayView<T>((T*)(Buffer.GetData() + Offset), Num); }
+};
+
+/** Maps a snapshot and exposes its sections in place */
+class FAISnapshotReader
+{
+public:
+	/**
+	 * Map a snapshot and validate its layout
+	 *
+	 * @param Path File to read
+	 * @return If the file is a complete snapshot of this version
+	 */
+	bool Open(const FString& Path);
+
+	const FAISnapshotHeader& GetHeader() const { return *File.GetHeader<FAISnapshotHeader>(); }
+
+	TArrayView<const FAISnapshotEntity> GetEntities() const
+	{
+		return Section<FAISnapshotEntity>(GetHeader().EntitiesOffset, GetHeader().EntityNum);
+	}
+
+	TArrayView<const FAIGene> GetGenes() const
+	{
+		return Section<FAIGene>(GetHeader().GenesOffset, GetHeader().GeneNum);
+	}
+
+	TArrayView<const float> GetNeurons() const
+	{
+		return Section<float>(GetHeader().NeuronsOffset, GetHeader().NeuronNum);
+	}
+
+	TArrayView<const float> GetPheromones() const
+	{
+		return Section<float>(GetHeader().PheromonesOffset, GetHeader().PheromoneNum);
+	}
+
+	TArrayView<const FAIBehavior> GetArchive() const
+	{
+		return Section<FAIBehavior>(GetHeader().ArchiveOffset, GetHeader().ArchiveNum);
+	}
+
+private:
+	FAIFileView File;
+
+	template <typename T>
+	TArrayView<const T> Section(uint64 Offset, int32 Num) const
+	{
+		return TArrayView<const T>((const T*)(File.GetData() + Offset), Num);
+	}
+};
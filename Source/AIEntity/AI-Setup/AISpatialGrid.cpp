@@ -0,0 +1,183 @@
+#include "AISpatialGrid.h"
+
+void FAISpatialGrid::Reset()
+{
+	Pending.Reset();
+}
+
+void FAISpatialGrid::Add(AActor* Actor, const FVector& Location, EAIGridKind Kind)
+{
+	Pending.Add({FVector2D(Location), Actor, Kind});
+}
+
+void FAISpatialGrid::Build()
+{
+	Entries.Reset();
+
+	if (Pending.IsEmpty())
+	{
+		Dimensions = FIntPoint(0, 0);
+		CellStart.Reset();
+		return;
+	}
+
+	// Fit the grid to whatever was added this build
+	FBox2D Bounds(ForceInit);
+	for (const FAISpatialGridEntry& Entry : Pending) Bounds += Entry.Location;
+
+	Origin = Bounds.Min;
+	Dimensions = FIntPoint(
+		FMath::Clamp(FMath::FloorToInt32((Bounds.Max.X - Bounds.Min.X) / CellSize) + 1, 1, MaxCellsPerAxis),
+		FMath::Clamp(FMath::FloorToInt32((Bounds.Max.Y - Bounds.Min.Y) / CellSize) + 1, 1, MaxCellsPerAxis)
+	);
+
+	// Counting sort by cell
+	CellStart.SetNumZeroed(Dimensions.X * Dimensions.Y + 1);
+
+	TArray<int32> EntryCell;
+	EntryCell.SetNumUninitialized(Pending.Num());
+
+	for (int32 i = 0; i < Pending.Num(); i++)
+	{
+		const FIntPoint Cell = CellOf(Pending[i].Location);
+		EntryCell[i] = Cell.Y * Dimensions.X + Cell.X;
+		CellStart[EntryCell[i] + 1]++;
+	}
+
+	for (int32 i = 1; i < CellStart.Num(); i++) CellStart[i] += CellStart[i - 1];
+
+	TArray<int32> Cursor(CellStart.GetData(), CellStart.Num() - 1);
+	Entries.SetNumUninitialized(Pending.Num());
+
+	for (int32 i = 0; i < Pending.Num(); i++) Entries[Cursor[EntryCell[i]]++] = Pending[i];
+
+	Pending.Reset();
+}
+
+FIntPoint FAISpatialGrid::CellOf(const FVector2D& Location) const
+{
+	return FIntPoint(
+		FMath::Clamp(FMath::FloorToInt32((Location.X - Origin.X) / CellSize), 0, Dimensions.X - 1),
+		FMath::Clamp(FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize), 0, Dimensions.Y - 1)
+	);
+}
+
+TArrayView<const FAISpatialGridEntry> FAISpatialGrid::CellEntries(const FIntPoint& Cell) const
+{
+	const int32 Index = Cell.Y * Dimensions.X + Cell.X;
+
+	return TArrayView<const FAISpatialGridEntry>(Entries.GetData() + CellStart[Index],
+	                                             CellStart[Index + 1] - CellStart[Index]);
+}
+
+const FAISpatialGridEntry* FAISpatialGrid::FindNearest(const FVector& Location, uint32 KindMask, float MaxDistance,
+                                                       const AActor* Ignore) const
+{
+	return FindNearestMatching(Location, MaxDistance, [KindMask, Ignore](const FAISpatialGridEntry& Entry)
+	{
+		return (KindMask & (1u << (uint8)Entry.Kind)) && Entry.Actor != Ignore;
+	});
+}
+
+const FAISpatialGridEntry* FAISpatialGrid::FindNearestAhead(const FVector& Location, const FVector& Direction,
+                                                            float MinCos, uint32 KindMask, float MaxDistance,
+                                                            const AActor* Ignore) const
+{
+	const FVector2D Location2D(Location);
+	const FVector2D Direction2D = FVector2D(Direction).GetSafeNormal();
+
+	return FindNearestMatching(Location, MaxDistance, [&](const FAISpatialGridEntry& Entry)
+	{
+		if (!(KindMask & (1u << (uint8)Entry.Kind)) || Entry.Actor == Ignore) return false;
+
+		const FVector2D Offset = Entry.Location - Location2D;
+
+		return FVector2D::DotProduct(Offset, Direction2D) >= Offset.Size() * MinCos;
+	});
+}
+
+void FAISpatialGrid::CountAlongLine(const FVector& Origin, const FVector& Direction, float MinT, float MaxT,
+                                    float Radius, uint32 KindMask, const AActor* Ignore, int32& OutBehind,
+                                    int32& OutAhead) const
+{
+	OutBehind = OutAhead = 0;
+
+	if (Entries.IsEmpty()) return;
+
+	const FVector2D Origin2D(Origin);
+	const FVector2D Direction2D = FVector2D(Direction).GetSafeNormal();
+
+	// Segment in cell units
+	const FVector2D Start = (Origin2D + Direction2D * MinT - this->Origin) / CellSize;
+	const FVector2D End = (Origin2D + Direction2D * MaxT - this->Origin) / CellSize;
+	const FVector2D Delta = End - Start;
+
+	FIntPoint Cell(FMath::FloorToInt32(Start.X), FMath::FloorToInt32(Start.Y));
+	const FIntPoint EndCell(FMath::FloorToInt32(End.X), FMath::FloorToInt32(End.Y));
+	const FIntPoint Step(Delta.X >= 0 ? 1 : -1, Delta.Y >= 0 ? 1 : -1);
+
+	// Amanatides-Woo walk: distance along the segment to the next cell border on each axis
+	FVector2D NextBorder(
+		Delta.X != 0 ? (Step.X > 0 ? Cell.X + 1 - Start.X : Start.X - Cell.X) / FMath::Abs(Delta.X) : BIG_NUMBER,
+		Delta.Y != 0 ? (Step.Y > 0 ? Cell.Y + 1 - Start.Y : Start.Y - Cell.Y) / FMath::Abs(Delta.Y) : BIG_NUMBER
+	);
+	const FVector2D BorderDelta(
+		Delta.X != 0 ? 1.0f / FMath::Abs(Delta.X) : BIG_NUMBER,
+		Delta.Y != 0 ? 1.0f / FMath::Abs(Delta.Y) : BIG_NUMBER
+	);
+
+	const int32 Reach = FMath::CeilToInt32(Radius / CellSize);
+	const int32 MaxWalk = FMath::Abs(EndCell.X - Cell.X) + FMath::Abs(EndCell.Y - Cell.Y);
+
+	// Cells crossed and their neighbors within the radius, overlaps removed afterwards
+	TArray<int32, TInlineAllocator<256>> Cells;
+
+	for (int32 Walk = 0; Walk <= MaxWalk; Walk++)
+	{
+		for (int32 Y = Cell.Y - Reach; Y <= Cell.Y + Reach; Y++)
+		{
+			for (int32 X = Cell.X - Reach; X <= Cell.X + Reach; X++)
+			{
+				if (X >= 0 && X < Dimensions.X && Y >= 0 && Y < Dimensions.Y) Cells.Add(Y * Dimensions.X + X);
+			}
+		}
+
+		if (Cell == EndCell) break;
+
+		if (NextBorder.X < NextBorder.Y)
+		{
+			Cell.X += Step.X;
+			NextBorder.X += BorderDelta.X;
+		}
+		else
+		{
+			Cell.Y += Step.Y;
+			NextBorder.Y += BorderDelta.Y;
+		}
+	}
+
+	Cells.Sort();
+
+	const float RadiusSq = FMath::Square(Radius);
+
+	for (int32 i = 0; i < Cells.Num(); i++)
+	{
+		if (i > 0 && Cells[i] == Cells[i - 1]) continue;
+
+		for (int32 Entry = CellStart[Cells[i]]; Entry < CellStart[Cells[i] + 1]; Entry++)
+		{
+			const FAISpatialGridEntry& Candidate = Entries[Entry];
+
+			if (!(KindMask & (1u << (uint8)Candidate.Kind)) || Candidate.Actor == Ignore) continue;
+
+			// Projection on the line and distance from it
+			const FVector2D Offset = Candidate.Location - Origin2D;
+			const float T = FVector2D::DotProduct(Offset, Direction2D);
+
+			if (T < MinT || T > MaxT || (Offset - Direction2D * T).SizeSquared() > RadiusSq) continue;
+
+			if (T < 0) OutBehind++;
+			else OutAhead++;
+		}
+	}
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** What a grid entry is, likeness kinds follow EAIEntityState */
+enum class EAIGridKind : uint8
+{
+	Entity,
+	Interested,
+	Neutral,
+	Wary
+};
+
+/** Single actor placed in the grid */
+struct FAISpatialGridEntry
+{
+	FVector2D Location;
+
+	AActor* Actor;
+
+	EAIGridKind Kind;
+};
+
+/**
+ * Dynamic uniform grid over the simulation plane. Entries are added unsorted and bucketed per cell
+ * in one counting-sort pass on Build, so every cell is a contiguous range of entries.
+ */
+class FAISpatialGrid
+{
+public:
+	static constexpr float CellSize = 500.0f;
+
+	/** Cells per axis are capped so sparse outliers can not blow up the cell table */
+	static constexpr int32 MaxCellsPerAxis = 512;
+
+	void Reset();
+
+	/** Queue an actor for the next build */
+	void Add(AActor* Actor, const FVector& Location, EAIGridKind Kind);
+
+	/** Bucket every queued entry into its cell */
+	void Build();
+
+	/**
+	 * Find the nearest entry of the given kinds searching rings of cells outwards
+	 *
+	 * @param Location Where to search from
+	 * @param KindMask Kinds to accept, one bit per EAIGridKind
+	 * @param MaxDistance Entries further away are ignored
+	 * @param Ignore Actor to skip, usually the one searching
+	 * @return Nearest entry or nullptr if none is in range
+	 */
+	const FAISpatialGridEntry* FindNearest(const FVector& Location, uint32 KindMask, float MaxDistance,
+	                                       const AActor* Ignore = nullptr) const;
+
+	/**
+	 * Find the nearest entry of the given kinds inside a cone in front of a location
+	 *
+	 * @param Location Where to search from
+	 * @param Direction Unit direction the cone opens towards
+	 * @param MinCos Cosine of the half angle of the cone
+	 * @param KindMask Kinds to accept, one bit per EAIGridKind
+	 * @param MaxDistance Entries further away are ignored
+	 * @param Ignore Actor to skip, usually the one searching
+	 * @return Nearest entry or nullptr if none is in range
+	 */
+	const FAISpatialGridEntry* FindNearestAhead(const FVector& Location, const FVector& Direction, float MinCos,
+	                                            uint32 KindMask, float MaxDistance,
+	                                            const AActor* Ignore = nullptr) const;
+
+	/**
+	 * Find the nearest entry accepted by a filter searching rings of cells outwards, read only so
+	 * it can run from worker threads
+	 *
+	 * @param Location Where to search from
+	 * @param MaxDistance Entries further away are ignored
+	 * @param Accept If an entry in range can be returned
+	 * @return Nearest entry or nullptr if none is in range
+	 */
+	template <typename AcceptType>
+	const FAISpatialGridEntry* FindNearestMatching(const FVector& Location, float MaxDistance,
+	                                               AcceptType&& Accept) const;
+
+	/**
+	 * Count entries of the given kinds within a radius of a line segment, walking only the cells the
+	 * segment crosses
+	 *
+	 * @param Origin Point the segment is measured from
+	 * @param Direction Unit direction of the segment
+	 * @param MinT Start of the segment along the direction, negative to extend behind the origin
+	 * @param MaxT End of the segment along the direction
+	 * @param Radius Distance from the segment an entry can be at
+	 * @param KindMask Kinds to count, one bit per EAIGridKind
+	 * @param Ignore Actor to skip, usually the one searching
+	 * @param OutBehind Entries projecting behind the origin
+	 * @param OutAhead Entries projecting at or ahead of the origin
+	 */
+	void CountAlongLine(const FVector& Origin, const FVector& Direction, float MinT, float MaxT, float Radius,
+	                    uint32 KindMask, const AActor* Ignore, int32& OutBehind, int32& OutAhead) const;
+
+	/** Cell containing a location, clamped to the grid */
+	FIntPoint CellOf(const FVector2D& Location) const;
+
+	/** Entries of a cell inside the grid */
+	TArrayView<const FAISpatialGridEntry> CellEntries(const FIntPoint& Cell) const;
+
+	/** Number of cells per axis */
+	FIntPoint GetDimensions() const { return Dimensions; }
+
+	/** Bit of a kind in a kind mask */
+	static constexpr uint32 KindBit(EAIGridKind Kind) { return 1u << (uint8)Kind; }
+
+private:
+	/** Entries added since the last build */
+	TArray<FAISpatialGridEntry> Pending;
+
+	TArray<FAISpatialGridEntry> Entries;
+
+	/** First entry of each cell, one extra element closes the last cell */
+	TArray<int32> CellStart;
+
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	FIntPoint Dimensions = FIntPoint(0, 0);
+};
+
+template <typename AcceptType>
+const FAISpatialGridEntry* FAISpatialGrid::FindNearestMatching(const FVector& Location, float MaxDistance,
+                                                               AcceptType&& Accept) const
+{
+	if (Entries.IsEmpty()) return nullptr;
+
+	const FVector2D Location2D(Location);
+	const FIntPoint Center = CellOf(Location2D);
+	const int32 MaxRing = FMath::Max(Dimensions.X, Dimensions.Y);
+
+	const FAISpatialGridEntry* Nearest = nullptr;
+	float NearestDistanceSq = FMath::Square(MaxDistance);
+
+	for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+	{
+		// Everything in this ring and beyond is further than what was already found
+		const float RingDistance = FMath::Max(0, Ring - 1) * CellSize;
+		if (FMath::Square(RingDistance) > NearestDistanceSq) break;
+
+		for (int32 Y = Center.Y - Ring; Y <= Center.Y + Ring; Y++)
+		{
+			if (Y < 0 || Y >= Dimensions.Y) continue;
+
+			// Only the border of the ring, inner cells were already visited
+			const bool bEdgeRow = Y == Center.Y - Ring || Y == Center.Y + Ring;
+			const int32 Step = bEdgeRow || Ring == 0 ? 1 : Ring * 2;
+
+			for (int32 X = Center.X - Ring; X <= Center.X + Ring; X += Step)
+			{
+				if (X < 0 || X >= Dimensions.X) continue;
+
+				for (const FAISpatialGridEntry& Entry : CellEntries(FIntPoint(X, Y)))
+				{
+					const float DistanceSq = FVector2D::DistSquared(Location2D, Entry.Location);
+
+					if (DistanceSq < NearestDistanceSq && Accept(Entry))
+					{
+						NearestDistanceSq = DistanceSq;
+						Nearest = &Entry;
+					}
+				}
+			}
+		}
+	}
+
+	return Nearest;
+}
@@ -0,0 +1,92 @@
+#include "AISpecies.h"
+#include "../AIEntity.h"
+#include "Hash/CityHash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Species Clustering"), STAT_AISpeciesClustering, STATGROUP_AIEntity);
+
+void FAISpeciesIndex::Build(TArrayView<const FAIGenomeSignature> Signatures)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AISpeciesClustering);
+
+	const int32 Num = Signatures.Num();
+
+	Roots.SetNumUninitialized(Num);
+	for (int32 i = 0; i < Num; i++) Roots[i] = i;
+
+	// Exact copies
+	Buckets.Reset();
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (const int32* First = Buckets.Find(Signatures[i].Hash)) Join(*First, i);
+		else Buckets.Add(Signatures[i].Hash, i);
+	}
+
+	Stats.UniqueGenomes = Buckets.Num();
+
+	// Entities sharing every row of a band are likely close
+	for (int32 Band = 0; Band < BandNum; Band++)
+	{
+		Buckets.Reset();
+
+		for (int32 i = 0; i < Num; i++)
+		{
+			const uint64 Key = CityHash64WithSeed((const char*)(Signatures[i].MinHash + Band * RowNum),
+			                                      RowNum * sizeof(uint32), Band);
+
+			if (const int32* First = Buckets.Find(Key)) Join(*First, i);
+			else Buckets.Add(Key, i);
+		}
+	}
+
+	// Number the species in the order their first entity appears
+	SpeciesOf.SetNumUninitialized(Num);
+	SpeciesSize.Reset();
+
+	TArray<int32> SpeciesOfRoot;
+	SpeciesOfRoot.Init(INDEX_NONE, Num);
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		int32& Species = SpeciesOfRoot[Find(i)];
+
+		if (Species == INDEX_NONE) Species = SpeciesSize.Add(0);
+
+		SpeciesOf[i] = Species;
+		SpeciesSize[Species]++;
+	}
+
+	Stats.SpeciesNum = SpeciesSize.Num();
+	Stats.LargestSpecies = 0;
+
+	double SameSpecies = 0.0;
+
+	for (int32 Size : SpeciesSize)
+	{
+		Stats.LargestSpecies = FMath::Max(Stats.LargestSpecies, Size);
+		SameSpecies += (double)Size * (Size - 1);
+	}
+
+	Stats.Diversity = Num > 1 ? 1.0f - (float)(SameSpecies / ((double)Num * (Num - 1))) : 0.0f;
+}
+
+int32 FAISpeciesIndex::Find(int32 Entity)
+{
+	// Path halving
+	while (Roots[Entity] != Entity)
+	{
+		Roots[Entity] = Roots[Roots[Entity]];
+		Entity = Roots[Entity];
+	}
+
+	return Entity;
+}
+
+void FAISpeciesIndex::Join(int32 A, int32 B)
+{
+	A = Find(A);
+	B = Find(B);
+
+	// The smaller index stays the root so species follow entity order
+	if (A != B) Roots[FMath::Max(A, B)] = FMath::Min(A, B);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIGenomeKernels.h"
+
+/** Diversity of a population */
+struct FAISpeciesStats
+{
+	/** Groups of entities with close genomes */
+	int32 SpeciesNum = 0;
+
+	/** Genomes that are not an exact copy of another one */
+	int32 UniqueGenomes = 0;
+
+	/** Entities of the most common species */
+	int32 LargestSpecies = 0;
+
+	/** Chance two entities picked at random belong to different species */
+	float Diversity = 0.0f;
+};
+
+/**
+ * Groups the population into species by locality-sensitive hashing of the genome sketches, genomes
+ * sharing about 70% of their genes fall into the same species
+ */
+class FAISpeciesIndex
+{
+public:
+	/** Bands the sketch is split into */
+	static constexpr int32 BandNum = 4;
+
+	/** Hash values in each band */
+	static constexpr int32 RowNum = AIMinHashNum / BandNum;
+
+	/**
+	 * Cluster a population
+	 *
+	 * @param Signatures Signature of every entity genome
+	 */
+	void Build(TArrayView<const FAIGenomeSignature> Signatures);
+
+	/**
+	 * Species of an entity, numbered from 0
+	 *
+	 * @param Entity Index of the entity in the signatures
+	 */
+	int32 GetSpecies(int32 Entity) const { return SpeciesOf[Entity]; }
+
+	/**
+	 * Entities in the species of an entity, the basis of fitness sharing
+	 *
+	 * @param Entity Index of the entity in the signatures
+	 */
+	int32 GetSpeciesSize(int32 Entity) const { return SpeciesSize[SpeciesOf[Entity]]; }
+
+	const FAISpeciesStats& GetStats() const { return Stats; }
+
+	int32 Num() const { return SpeciesOf.Num(); }
+
+private:
+	TArray<int32> SpeciesOf;
+
+	TArray<int32> SpeciesSize;
+
+	FAISpeciesStats Stats;
+
+	/** Union-find forest the species are joined in */
+	TArray<int32> Roots;
+
+	/** First entity of every bucket */
+	TMap<uint64, int32> Buckets;
+
+	int32 Find(int32 Entity);
+
+	void Join(int32 A, int32 B);
+};
@@ -0,0 +1,94 @@
+#include "AITraits.h"
+#include "../AIEntity.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Traits Step"), STAT_AITraitsStep, STATGROUP_AIEntity);
+
+void FAITraitStore::Add()
+{
+	EntityNum++;
+
+	// Slots past the last entity are padding for the vector lanes
+	const int32 Padded = Align(EntityNum, 4);
+	ForEachColumn([Padded](TArray<float>& Column) { Column.SetNumZeroed(Padded); });
+
+	Reset(EntityNum - 1);
+}
+
+void FAITraitStore::RemoveAt(int32 Index)
+{
+	ForEachColumn([Index](TArray<float>& Column)
+	{
+		Column.RemoveAt(Index);
+		Column.Add(0.0f);
+	});
+
+	EntityNum--;
+}
+
+void FAITraitStore::Reset(int32 Index)
+{
+	Health[Index] = 1.0f;
+	Stamina[Index] = 1.0f;
+	Speed[Index] = 1.0f;
+	Moved[Index] = Sprint[Index] = Heal[Index] = Damage[Index] = 0.0f;
+}
+
+void FAITraitStore::Step()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AITraitsStep);
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float MoveCost = VectorSetFloat1(Rates.MoveCost);
+	const VectorRegister4Float SprintCost = VectorSetFloat1(Rates.SprintCost);
+	const VectorRegister4Float HealCost = VectorSetFloat1(Rates.HealCost);
+	const VectorRegister4Float Recovery = VectorSetFloat1(Rates.Recovery);
+	const VectorRegister4Float HealRate = VectorSetFloat1(Rates.HealRate);
+	const VectorRegister4Float SprintBoost = VectorSetFloat1(Rates.SprintBoost);
+	const VectorRegister4Float ExhaustedSpeed = VectorSetFloat1(Rates.ExhaustedSpeed);
+	const VectorRegister4Float StaminaSpeed = VectorSetFloat1(1.0f - Rates.ExhaustedSpeed);
+
+	float* HealthData = Health.GetData();
+	float* StaminaData = Stamina.GetData();
+	float* SpeedData = Speed.GetData();
+	float* MovedData = Moved.GetData();
+	float* SprintData = Sprint.GetData();
+	float* HealData = Heal.GetData();
+	float* DamageData = Damage.GetData();
+
+	for (int32 i = 0; i < EntityNum; i += 4)
+	{
+		const VectorRegister4Float MovedLevel = VectorLoad(MovedData + i);
+		const VectorRegister4Float SprintLevel = VectorLoad(SprintData + i);
+		const VectorRegister4Float HealLevel = VectorLoad(HealData + i);
+
+		// Stamina drains with movement and the actions spending it, and recovers every step
+		VectorRegister4Float NewStamina = VectorLoad(StaminaData + i);
+		NewStamina = VectorAdd(NewStamina, Recovery);
+		NewStamina = VectorNegateMultiplyAdd(MovedLevel, MoveCost, NewStamina);
+		NewStamina = VectorNegateMultiplyAdd(SprintLevel, SprintCost, NewStamina);
+		NewStamina = VectorNegateMultiplyAdd(HealLevel, HealCost, NewStamina);
+		NewStamina = VectorMin(VectorMax(NewStamina, Zero), One);
+
+		// Health drops with damage and heals while stamina lasts
+		const VectorRegister4Float HasStamina = VectorCompareGT(NewStamina, Zero);
+		VectorRegister4Float NewHealth = VectorLoad(HealthData + i);
+		NewHealth = VectorSubtract(NewHealth, VectorLoad(DamageData + i));
+		NewHealth = VectorAdd(NewHealth, VectorSelect(HasStamina, VectorMultiply(HealLevel, HealRate), Zero));
+		NewHealth = VectorMin(VectorMax(NewHealth, Zero), One);
+
+		// Tired entities slow down, sprinting speeds them up
+		VectorRegister4Float NewSpeed = VectorMultiplyAdd(NewStamina, StaminaSpeed, ExhaustedSpeed);
+		NewSpeed = VectorMultiply(NewSpeed, VectorMultiplyAdd(SprintLevel, SprintBoost, One));
+
+		VectorStore(NewStamina, StaminaData + i);
+		VectorStore(NewHealth, HealthData + i);
+		VectorStore(NewSpeed, SpeedData + i);
+
+		VectorStore(Zero, MovedData + i);
+		VectorStore(Zero, SprintData + i);
+		VectorStore(Zero, HealData + i);
+		VectorStore(Zero, DamageData + i);
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Rates the traits change at every step, in fractions of the full trait */
+struct FAITraitRates
+{
+	/** Stamina spent by a step with any movement */
+	float MoveCost = 0.002f;
+
+	/** Stamina spent by a step sprinting at full level */
+	float SprintCost = 0.01f;
+
+	/** Stamina spent by a step healing at full level */
+	float HealCost = 0.01f;
+
+	/** Stamina regained every step */
+	float Recovery = 0.004f;
+
+	/** Health regained by a step healing at full level */
+	float HealRate = 0.01f;
+
+	/** Extra speed of a step sprinting at full level */
+	float SprintBoost = 0.5f;
+
+	/** Speed left when out of stamina */
+	float ExhaustedSpeed = 0.5f;
+};
+
+/**
+ * Physical traits of the whole population, one array per trait indexed like the entity registry,
+ * advanced for everyone in one vectorized pass once the step is taken
+ */
+class FAITraitStore
+{
+public:
+	/** Highest speed scale, sprinting at full level with full stamina */
+	float MaxSpeed() const { return 1.0f + Rates.SprintBoost; }
+
+	/** Add an entity with full traits at the end */
+	void Add();
+
+	/** Remove an entity, later entities move down one slot */
+	void RemoveAt(int32 Index);
+
+	/** Restore full traits and drop pending inputs of an entity */
+	void Reset(int32 Index);
+
+	/** Advance every trait by one step and clear the inputs */
+	void Step();
+
+	int32 Num() const { return EntityNum; }
+
+	FAITraitRates Rates;
+
+	/** Traits in the range 0.0..1.0 */
+	TArray<float> Health;
+	TArray<float> Stamina;
+
+	/** Scale of the walk speed, fed into the mover */
+	TArray<float> Speed;
+
+	/** Inputs of the current step, movement as 0.0 or 1.0 and action levels in the range 0.0..1.0 */
+	TArray<float> Moved;
+	TArray<float> Sprint;
+	TArray<float> Heal;
+
+	/** Health lost to interactions this step */
+	TArray<float> Damage;
+
+private:
+	int32 EntityNum = 0;
+
+	/** Call a function on every trait and input array */
+	template <typename FunctionType>
+	void ForEachColumn(FunctionType&& Function)
+	{
+		for (TArray<float>* Column : {&Health, &Stamina, &Speed, &Moved, &Sprint, &Heal, &Damage}) Function(*Column);
+	}
+};
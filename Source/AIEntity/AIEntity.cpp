@@ -3,4 +3,6 @@
 #include "AIEntity.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogAIEntity);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, AIEntity, "AIEntity" );
\ No newline at end of file
@@ -2,4 +2,9 @@
 
 #pragma once
 
-#include "CoreMinimal.h"
\ No newline at end of file
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogAIEntity, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("AIEntity"), STATGROUP_AIEntity, STATCAT_Advanced);
\ No newline at end of file
@@ -429,6 +429,26 @@ void AActionSetup::AdvanceAimEnd()
 	CurrentRotationMode = RotationMode::LookingDirection;
 }
 
+void AActionSetup::SaveMotion(FActionMotion& OutMotion) const
+{
+	OutMotion.PreviousVelocity = PreviousVelocity;
+	OutMotion.PreviousAimYaw = PreviousAimYaw;
+	OutMotion.InAirRotation = InAirRotation;
+	OutMotion.LastVelocityRotation = LastVelocityRotation;
+	OutMotion.LastMovementInputRotation = LastMovementInputRotation;
+	OutMotion.TargetRotation = TargetRotation;
+}
+
+void AActionSetup::LoadMotion(const FActionMotion& Motion)
+{
+	PreviousVelocity = Motion.PreviousVelocity;
+	PreviousAimYaw = Motion.PreviousAimYaw;
+	InAirRotation = Motion.InAirRotation;
+	LastVelocityRotation = Motion.LastVelocityRotation;
+	LastMovementInputRotation = Motion.LastMovementInputRotation;
+	TargetRotation = Motion.TargetRotation;
+}
+
 /*********************************************************************************************
 * Events
 ********************************************************************************************* */
@@ -19,6 +19,17 @@ struct FInputActionValue;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
+/** Movement values the character carries from one frame to the next */
+struct FActionMotion
+{
+	FVector PreviousVelocity;
+	float PreviousAimYaw;
+	FRotator InAirRotation;
+	FRotator LastVelocityRotation;
+	FRotator LastMovementInputRotation;
+	FRotator TargetRotation;
+};
+
 UCLASS(config=Game)
 class AActionSetup : public ACharacter, public ICharacter_INTF
 {
@@ -138,6 +149,20 @@ protected:
 	 */
 	void SetRagdollMontage(FString PathFolder, TMap<FString, TArray<OverlayState>> States, bool IsFront = true);
 
+	/**
+	 * Get the movement values carried between frames
+	 *
+	 * @param OutMotion Movement values of the character
+	 */
+	void SaveMotion(FActionMotion& OutMotion) const;
+
+	/**
+	 * Restore the movement values carried between frames
+	 *
+	 * @param Motion Movement values to restore
+	 */
+	void LoadMotion(const FActionMotion& Motion);
+
 public:
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
@@ -0,0 +1,120 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIBrain.h"
+#include "../AI-Setup/AIGenomeKernels.h"
+#include "../AI-Setup/AISensorRecording.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+static FAIGene MakeGene(uint8 SourceType, uint8 SourceNum, uint8 SinkType, uint8 SinkNum, int16 Weight)
+{
+	FAIGene Gene;
+	Gene.SourceType = SourceType;
+	Gene.SourceNum = SourceNum;
+	Gene.SinkType = SinkType;
+	Gene.SinkNum = SinkNum;
+	Gene.Weight = Weight;
+	return Gene;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIBrainWireTest, "AIEntity.Brain.WiresOnlyNeuronsReachingActions",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIBrainWireTest::RunTest(const FString& Parameters)
+{
+	constexpr uint8 Sensor = FAIBrain::SENSOR, Action = FAIBrain::ACTION, Neuron = FAIBrain::NEURON;
+
+	const FAIGene Genome[] = {
+		MakeGene(Sensor, (uint8)EAISensory::AGE, Neuron, 3, 4096),
+		MakeGene(Neuron, 3, Action, (uint8)EAIActions::MOVE_X, 8192),
+		MakeGene(Neuron, 5, Neuron, 5, 8192), // Only feeds itself
+		MakeGene(Sensor, (uint8)EAISensory::RANDOM, Neuron, 7, 8192), // Never reaches an action
+		MakeGene(Neuron, 7, Neuron, 9, 8192),
+	};
+
+	FAINeuralNet Net;
+	FAIBrain::Wire(Genome, 40, Net);
+
+	TestEqual(TEXT("Neurons kept"), Net.Neurons.Num(), 1);
+
+	if (!TestEqual(TEXT("Connections kept"), Net.Connections.Num(), 2)) return false;
+
+	// The sensor feeding the kept neuron is wired into its remapped number, before the actions
+	const FAIGene& Into = Net.Connections[0];
+	TestTrue(TEXT("Sensor connection kept"), Into.SourceType == Sensor && Into.SourceNum == (uint8)EAISensory::AGE);
+	TestTrue(TEXT("Neuron remapped"), Into.SinkType == Neuron && Into.SinkNum == 0);
+
+	const FAIGene& Out = Net.Connections[1];
+	TestTrue(TEXT("Action connection kept once"), Out.SourceType == Neuron && Out.SourceNum == 0 &&
+	         Out.SinkType == Action && Out.SinkNum == (uint8)EAIActions::MOVE_X);
+
+	TestEqual(TEXT("Wired sensors"), Net.WiredSensors, 1ull << (uint8)EAISensory::AGE);
+	TestTrue(TEXT("Kept neuron is driven"), Net.Neurons[0].Driven);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAISensorReplayTest, "AIEntity.Brain.SensorRecordingReplaysExactly",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAISensorReplayTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 EntityNum = 4, StepNum = 50, GeneNum = 24, MaxNumberNeurons = 40;
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Tests") / TEXT("Replay.aisr");
+	FRandomStream Random(11);
+
+	// The first two entities share a genome, it is stored once
+	TArray<FAIGene> Genomes[EntityNum];
+	FAINeuralNet Nets[EntityNum];
+
+	for (int32 i = 0; i < EntityNum; i++)
+	{
+		Genomes[i].SetNumUninitialized(GeneNum);
+		FAIGenomeKernels::RandomGenes(Genomes[i].GetData(), GeneNum, Random);
+	}
+
+	Genomes[1] = Genomes[0];
+
+	FAISensorRecorder Recorder;
+	if (!TestTrue(TEXT("Recording opened"), Recorder.Open(Path))) return false;
+
+	for (int32 i = 0; i < EntityNum; i++) FAIBrain::Wire(Genomes[i], MaxNumberNeurons, Nets[i]);
+
+	for (int32 Step = 0; Step < StepNum; Step++)
+	{
+		for (int32 i = 0; i < EntityNum; i++)
+		{
+			FAISensorValues Sensors;
+			FAIActionLevels Levels;
+
+			for (float& Value : Sensors.Values) Value = Random.GetFraction();
+
+			FAISensorRecorder::Quantize(Sensors);
+			Recorder.PrepareStep(i, Genomes[i], MaxNumberNeurons, Nets[i]);
+			FAIBrain::Evaluate(Nets[i], Sensors, Levels);
+			Recorder.RecordStep(i, Step, Sensors, Levels);
+		}
+	}
+
+	Recorder.Close();
+
+	FAISensorReplayReport Report;
+	const bool bReplayed = FAISensorReplay::Run(Path, Report);
+
+	IFileManager::Get().Delete(*Path);
+
+	if (!TestTrue(TEXT("Recording replayed"), bReplayed)) return false;
+
+	TestEqual(TEXT("Distinct genomes"), Report.Genomes, EntityNum - 1);
+	TestEqual(TEXT("Wirings"), Report.Wirings, EntityNum);
+	TestEqual(TEXT("Steps"), Report.Steps, EntityNum * StepNum);
+	TestEqual(TEXT("Mismatches"), Report.Mismatches, 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIGenerationLog.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static void SubmitGeneration(FAIGenerationLogWriter& Writer, uint32 Generation)
+{
+	FAIGenerationColumns Columns;
+	Columns.Generation = Generation;
+	Columns.SetNum(8);
+
+	for (int32 i = 0; i < Columns.Num(); i++)
+	{
+		Columns.SuccessRate[i] = i % 2;
+		Columns.GenomeLength[i] = 16 + i;
+		Columns.WiredSensors[i] = 1ull << i;
+		Columns.WiredActions[i] = 1ull << (i + 1);
+	}
+
+	Writer.Submit(MoveTemp(Columns));
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIGenerationLogAppendTest, "AIEntity.GenerationLog.ReopeningAppends",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIGenerationLogAppendTest::RunTest(const FString& Parameters)
+{
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Tests") / TEXT("Generations.aigl");
+	FAIGenerationLogWriter Writer;
+
+	if (!TestTrue(TEXT("Log opened"), Writer.Open(Path))) return false;
+
+	SubmitGeneration(Writer, 0);
+	SubmitGeneration(Writer, 1);
+	Writer.Close();
+
+	// A crash while writing the next generation leaves the start of its block behind
+	TArray<uint8> Data;
+	FFileHelper::LoadFileToArray(Data, *Path);
+	Data.AddZeroed(7);
+	FFileHelper::SaveArrayToFile(Data, *Path);
+
+	if (!TestTrue(TEXT("Log reopened"), Writer.Open(Path, true))) return false;
+
+	SubmitGeneration(Writer, 2);
+	Writer.Close();
+
+	TArray<uint32> Generations;
+	float SurvivalRate = 0.0f;
+
+	const bool bRead = FAIGenerationLogReader::Read(Path, [&](const FAIGenerationColumns& Columns)
+	{
+		Generations.Add(Columns.Generation);
+		SurvivalRate = Columns.SurvivalRate();
+	});
+
+	IFileManager::Get().Delete(*Path);
+
+	TestTrue(TEXT("Log read"), bRead);
+	TestEqual(TEXT("Generations kept across the torn reopen"), Generations, TArray<uint32>({0, 1, 2}));
+	TestEqual(TEXT("Columns survive the round trip"), SurvivalRate, 0.5f);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "AITestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIPopulationSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+/** Fingerprint of a fresh world after a number of frames */
+static uint64 RunFingerprint(int32 EntityNum, int32 Seed, int32 Frames, uint32* OutGeneration = nullptr)
+{
+	FAITestWorld TestWorld(EntityNum, Seed);
+	TestWorld.Step(Frames);
+
+	if (OutGeneration) *OutGeneration = TestWorld.GetPopulation().GetGeneration();
+
+	return TestWorld.Fingerprint();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIMatingDeterminismTest, "AIEntity.Generation.MatingTurnoversRepeat",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIMatingDeterminismTest::RunTest(const FString& Parameters)
+{
+	// Mates pair up in parallel rounds, the pairs may not depend on how the rounds were scheduled
+	FAIScopedConsoleVariable Mating(TEXT("AIEntity.Mating"), 1);
+
+	constexpr int32 EntityNum = 27, Seed = 17, Frames = 620;
+
+	const uint64 First = RunFingerprint(EntityNum, Seed, Frames);
+
+	TestEqual(TEXT("Repeated run"), RunFingerprint(EntityNum, Seed, Frames), First);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAISteadyStateDeterminismTest, "AIEntity.Generation.SteadyStateReplacementsRepeat",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAISteadyStateDeterminismTest::RunTest(const FString& Parameters)
+{
+	FAIScopedConsoleVariable SteadyState(TEXT("AIEntity.SteadyState"), 1);
+
+	// Entities age out from step 300 on, a few of them every step
+	constexpr int32 EntityNum = 27, Seed = 19, Frames = 400;
+	uint32 Generation = 0;
+
+	const uint64 First = RunFingerprint(EntityNum, Seed, Frames, &Generation);
+
+	TestTrue(TEXT("Entities were replaced"), Generation > 0);
+	TestEqual(TEXT("Repeated run"), RunFingerprint(EntityNum, Seed, Frames), First);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include "AITestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIEntityCharacter.h"
+#include "../AI-Setup/AIPopulationSubsystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIJournalRecoverTest, "AIEntity.Journal.RecoveryReachesTheJournaledGeneration",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIJournalRecoverTest::RunTest(const FString& Parameters)
+{
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Tests") / TEXT("Journaled.aisn");
+	constexpr int32 EntityNum = 9, Seed = 13;
+
+	// Only the snapshot taken here is journaled against, mating decisions are replayed along with survival
+	FAIScopedConsoleVariable Journal(TEXT("AIEntity.Journal"), 1);
+	FAIScopedConsoleVariable Mating(TEXT("AIEntity.Mating"), 1);
+	FAIScopedConsoleVariable SnapshotInterval(TEXT("AIEntity.SnapshotInterval"), 0);
+
+	uint64 Journaled = 0;
+
+	{
+		FAITestWorld TestWorld(EntityNum, Seed);
+		TestWorld.Step(1);
+		TestWorld.GetPopulation().SaveSnapshot(Path);
+
+		while (TestWorld.GetPopulation().GetGeneration() < 2) TestWorld.Step(1);
+
+		Journaled = TestWorld.Fingerprint();
+	}
+
+	// Recovering with the journal on would take a new snapshot over the one being tested
+	Journal.Set(0);
+
+	{
+		FAITestWorld TestWorld(EntityNum, Seed);
+		TestWorld.Step(1);
+
+		if (TestTrue(TEXT("Recovered"), TestWorld.GetPopulation().Recover(Path)))
+		{
+			TestEqual(TEXT("Recovered generation"), TestWorld.GetPopulation().GetGeneration(), 2u);
+			TestEqual(TEXT("Recovered state"), TestWorld.Fingerprint(), Journaled);
+		}
+	}
+
+	IFileManager::Get().Delete(*Path, false, true, true);
+	IFileManager::Get().Delete(*FPaths::ChangeExtension(Path, TEXT("aijr")), false, true, true);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIJournalRangeTest, "AIEntity.Journal.RecordsOutsideTheGenomesAreRejected",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIJournalRangeTest::RunTest(const FString& Parameters)
+{
+	FAITestWorld TestWorld(4, 3);
+	TestWorld.Step(1);
+
+	const TArray<TObjectPtr<AAIEntityCharacter>>& Entities = TestWorld.GetPopulation().GetEntities();
+	const int32 Num = Entities.Num();
+	const FAIGenerationParams Params;
+
+	// Every entity copies its own genome unchanged
+	FAIGenerationDelta Valid;
+	Valid.Generation = 1;
+	Valid.Survived.Init(true, Num);
+	Valid.Crossovers.Init(FAICrossover(), Num);
+	Valid.EditStart.Init(0, Num + 1);
+
+	for (int32 i = 0; i < Num; i++) Valid.ParentOf.Add(i);
+
+	TestTrue(TEXT("Unchanged copies"), FAIGenerationEngine::CanReplay(Entities, Params, Valid));
+
+	const int32 GeneNum = Entities[0]->GetGenomeSpan().Num;
+
+	auto WithEdits = [&](std::initializer_list<FAIGenomeEdit> Edits)
+	{
+		FAIGenerationDelta Delta = Valid;
+		Delta.Edits = Edits;
+
+		for (int32 i = 1; i <= Num; i++) Delta.EditStart[i] = Delta.Edits.Num();
+
+		return FAIGenerationEngine::CanReplay(Entities, Params, Delta);
+	};
+
+	TestTrue(TEXT("Last bit flipped"), WithEdits({{EAIGenomeEdit::Flip, GeneNum * 32 - 1, 0}}));
+	TestFalse(TEXT("Bit past the genome flipped"), WithEdits({{EAIGenomeEdit::Flip, GeneNum * 32, 0}}));
+	TestTrue(TEXT("Gene appended"), WithEdits({{EAIGenomeEdit::Insert, GeneNum, 0}}));
+	TestFalse(TEXT("Gene inserted past the end"), WithEdits({{EAIGenomeEdit::Insert, GeneNum + 1, 0}}));
+	TestFalse(TEXT("Two genes inserted"),
+	          WithEdits({{EAIGenomeEdit::Insert, 0, 0}, {EAIGenomeEdit::Insert, 0, 0}}));
+	TestFalse(TEXT("Gene past the end deleted"), WithEdits({{EAIGenomeEdit::Delete, GeneNum, 0}}));
+
+	FAIGenerationDelta Crossed = Valid;
+	Crossed.Crossovers[0] = {1, 0, GeneNum + 1};
+	TestFalse(TEXT("Crossover past the genomes"), FAIGenerationEngine::CanReplay(Entities, Params, Crossed));
+
+	FAIGenerationDelta Random = Valid;
+	Random.ParentOf[0] = INDEX_NONE;
+	Random.RandomNum.Add(Params.GenomeMaxLength + 1);
+	Random.RandomGenes.SetNumZeroed(Params.GenomeMaxLength + 1);
+	TestFalse(TEXT("Random genome past the max length"), FAIGenerationEngine::CanReplay(Entities, Params, Random));
+
+	return true;
+}
+
+#endif
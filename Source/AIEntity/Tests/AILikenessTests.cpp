@@ -0,0 +1,38 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIEntityCharacter.h"
+#include "../AI-Setup/AILikenessRegistry.h"
+#include "GameFramework/Character.h"
+#include "Misc/AutomationTest.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAILikenessClassifyTest, "AIEntity.Likeness.ClassifiesSubclasses",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAILikenessClassifyTest::RunTest(const FString& Parameters)
+{
+	FAILikenessObjects Objects;
+	Objects.WaryObjects.Add(TSoftObjectPtr<UObject>(ACharacter::StaticClass()));
+
+	FAILikenessRegistry Registry;
+	TArray<FSoftObjectPath> Paths;
+	TArray<TPair<AActor*, EAIEntityState>> Actors;
+
+	Registry.Register(Objects, Paths);
+	Registry.Resolve(Paths, Actors);
+
+	EAIEntityState State = EAIEntityState::Neutral;
+
+	TestTrue(TEXT("Listed class is classified"), Registry.Classify(GetDefault<ACharacter>(), State));
+	TestTrue(TEXT("Subclass is classified"), Registry.Classify(GetDefault<AAIEntityCharacter>(), State));
+	TestTrue(TEXT("Subclass takes the state of its parent"), State == EAIEntityState::Wary);
+
+	// Classified again from the class cache
+	TestTrue(TEXT("Subclass is classified twice"), Registry.Classify(GetDefault<AAIEntityCharacter>(), State));
+	TestFalse(TEXT("Parent class is not classified"), Registry.Classify(GetDefault<AActor>(), State));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIGenomeKernels.h"
+#include "../AI-Setup/AILineage.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+static TArray<FAIGene> MakeGenome(FRandomStream& Random, int32 Num)
+{
+	TArray<FAIGene> Genome;
+	Genome.SetNumUninitialized(Num);
+	FAIGenomeKernels::RandomGenes(Genome.GetData(), Num, Random);
+	return Genome;
+}
+
+static bool SameGenome(TArrayView<const FAIGene> A, TArrayView<const FAIGene> B)
+{
+	return A.Num() == B.Num() && FMemory::Memcmp(A.GetData(), B.GetData(), A.Num() * sizeof(FAIGene)) == 0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAILineageReopenTest, "AIEntity.Lineage.ReopeningContinuesTheRun",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAILineageReopenTest::RunTest(const FString& Parameters)
+{
+	const FString Directory = FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Tests") / TEXT("Lineage");
+	constexpr uint32 RunSeed = 5;
+	FRandomStream Random(5);
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	const TArray<FAIGene> First[] = {MakeGenome(Random, 12), MakeGenome(Random, 16)};
+	const TArray<FAIGene> Later[] = {MakeGenome(Random, 10), MakeGenome(Random, 14)};
+	const TArrayView<const FAIGene> FirstViews[] = {First[0], First[1]};
+	const TArrayView<const FAIGene> SwappedViews[] = {First[1], First[0]};
+	const TArrayView<const FAIGene> LaterViews[] = {Later[0], Later[1]};
+
+	// Generation 1 swaps the genomes of generation 0 without mutating them
+	FAIGenerationDelta Delta;
+	Delta.Generation = 1;
+	Delta.ParentOf = {1, 0};
+	Delta.Crossovers.SetNum(2);
+	Delta.EditStart.Init(0, 3);
+
+	{
+		FAILineageStore Store;
+		if (!TestTrue(TEXT("Lineage opened"), Store.Open(Directory, RunSeed, 0, 100, FirstViews))) return false;
+
+		Store.Append(Delta, SwappedViews);
+	}
+
+	// Reopened later, the generations in between are missing
+	{
+		FAILineageStore Store;
+		TestTrue(TEXT("Lineage reopened"), Store.Open(Directory, RunSeed, 5, 100, LaterViews));
+	}
+
+	{
+		FAILineageReader Reader;
+		if (!TestTrue(TEXT("Lineage read"), Reader.Open(Directory))) return false;
+
+		TArray<FAIGene> Genome;
+		TArray<FAILineageId> Ancestors;
+
+		TestEqual(TEXT("First generation kept"), Reader.GetFirstGeneration(), 0u);
+		TestEqual(TEXT("Last generation"), Reader.GetLastGeneration(), 5u);
+		TestTrue(TEXT("Earlier child rebuilt"), Reader.Reconstruct({1, 0}, Genome) && SameGenome(Genome, First[1]));
+		TestTrue(TEXT("Later anchor rebuilt"), Reader.Reconstruct({5, 1}, Genome) && SameGenome(Genome, Later[1]));
+		TestFalse(TEXT("Missing generation not rebuilt"), Reader.Reconstruct({3, 0}, Genome));
+		TestTrue(TEXT("Earlier ancestors walked"), Reader.Ancestors({1, 0}, Ancestors) && Ancestors.Num() == 1 &&
+		         Ancestors[0].Generation == 0 && Ancestors[0].Entity == 1);
+	}
+
+	// Reopened at an earlier generation, as after loading a snapshot, the later records are dropped
+	{
+		FAILineageStore Store;
+		TestTrue(TEXT("Lineage rewound"), Store.Open(Directory, RunSeed, 1, 100, LaterViews));
+	}
+
+	{
+		FAILineageReader Reader;
+		if (!TestTrue(TEXT("Rewound lineage read"), Reader.Open(Directory))) return false;
+
+		TArray<FAIGene> Genome;
+
+		TestEqual(TEXT("Rewound last generation"), Reader.GetLastGeneration(), 1u);
+		TestTrue(TEXT("Generation 0 kept"), Reader.Reconstruct({0, 0}, Genome) && SameGenome(Genome, First[0]));
+		TestTrue(TEXT("Rewound anchor rebuilt"), Reader.Reconstruct({1, 0}, Genome) && SameGenome(Genome, Later[0]));
+	}
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	return true;
+}
+
+#endif
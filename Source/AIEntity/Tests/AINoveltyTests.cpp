@@ -0,0 +1,113 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AINovelty.h"
+#include "Misc/AutomationTest.h"
+
+/** Behavior of an entity wandering around a random spot of the known space */
+static FAIBehavior MakeBehavior(FRandomStream& Random)
+{
+	const FVector2D KnownMin(0.0, 0.0), KnownMax(1.0, 1.0);
+	const FVector2D Center(Random.GetFraction(), Random.GetFraction());
+	const float Spread = Random.GetFraction() * 0.5f;
+
+	float ActionRates[AIBehaviorActionNum];
+	for (float& Rate : ActionRates) Rate = FMath::Square(Random.GetFraction());
+
+	FAIBehaviorAccumulator Accumulator;
+	FVector2D Location = Center;
+
+	for (int32 Step = 0; Step < 32; Step++)
+	{
+		Location = Center + FVector2D(Random.FRandRange(-Spread, Spread), Random.FRandRange(-Spread, Spread));
+		Accumulator.Step(Location, KnownMin, KnownMax);
+
+		for (int32 Action = 0; Action < AIBehaviorActionNum; Action++)
+		{
+			if (Random.GetFraction() < ActionRates[Action]) Accumulator.Act((EAIBehaviorAction)Action);
+		}
+	}
+
+	FAIBehavior Behavior;
+	Accumulator.Describe(Location, KnownMin, KnownMax, Behavior);
+
+	return Behavior;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAINoveltyArchiveLoadTest, "AIEntity.Novelty.LoadedArchiveScoresTheSame",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAINoveltyArchiveLoadTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 K = 15, MaxChecks = 256;
+	FRandomStream Random(9);
+
+	// Three full buckets leave trees on the first two levels and a partial bucket
+	FAINoveltyArchive Archive;
+	for (int32 i = 0; i < 3 * FAINoveltyArchive::BucketSize + 100; i++) Archive.Add(MakeBehavior(Random));
+
+	TArray<FAIBehavior> Saved;
+	Archive.Save(Saved);
+
+	FAINoveltyArchive Loaded;
+	Loaded.Load(Saved);
+
+	TestEqual(TEXT("Behaviors loaded"), Loaded.Num(), Archive.Num());
+
+	TArray<FAIBehavior> Population;
+	for (int32 i = 0; i < 200; i++) Population.Add(MakeBehavior(Random));
+
+	// Capped searches depend on the layout of the trees, so they only agree if it was rebuilt exactly
+	for (const int32 Checks : {0, MaxChecks})
+	{
+		TArray<float> Novelty, LoadedNovelty;
+		Archive.Score(Population, K, Checks, Novelty);
+		Loaded.Score(Population, K, Checks, LoadedNovelty);
+
+		TestTrue(FString::Printf(TEXT("Same novelty with %d checks"), Checks), Novelty == LoadedNovelty);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAINoveltyScoreBenchmark, "AIEntity.Perf.NoveltyScore",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FAINoveltyScoreBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 PopulationNum = 1000, K = 15, MaxChecks = 4096;
+	FRandomStream Random(21);
+
+	TArray<FAIBehavior> Population;
+	for (int32 i = 0; i < PopulationNum; i++) Population.Add(MakeBehavior(Random));
+
+	FAINoveltyArchive Archive;
+
+	for (const int32 ArchiveNum : {10000, 100000, 500000})
+	{
+		while (Archive.Num() < ArchiveNum) Archive.Add(MakeBehavior(Random));
+
+		TArray<float> Exact, Approximate;
+
+		double StartTime = FPlatformTime::Seconds();
+		Archive.Score(Population, K, 0, Exact);
+		const double ExactSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		Archive.Score(Population, K, MaxChecks, Approximate);
+		const double ApproximateSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// Capped searches can only miss neighbors, so they never score below the exact novelty
+		double Error = 0.0;
+		for (int32 i = 0; i < PopulationNum; i++) Error += (Approximate[i] - Exact[i]) / FMath::Max(Exact[i], 1e-6f);
+
+		AddInfo(FString::Printf(TEXT("%d archived: exact %.2f ms, %d checks %.2f ms, mean novelty error %.2f%%"),
+		                        ArchiveNum, ExactSeconds * 1000.0, MaxChecks, ApproximateSeconds * 1000.0,
+		                        Error * 100.0 / PopulationNum));
+	}
+
+	return true;
+}
+
+#endif
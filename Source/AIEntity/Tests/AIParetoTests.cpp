@@ -0,0 +1,123 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIGeneration.h"
+#include "../AI-Setup/AIPareto.h"
+#include "Misc/AutomationTest.h"
+
+/** Objectives shaped like those of a generation: survival is binary and diversity comes from a few species */
+static void FillObjectives(TArray<float>& Objectives, TArray<int32>& Members, int32 Num, int32 Seed)
+{
+	FRandomStream Random(Seed);
+
+	Objectives.SetNumUninitialized(Num * AIObjectiveNum);
+	Members.SetNumUninitialized(Num);
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		float* Values = Objectives.GetData() + i * AIObjectiveNum;
+
+		Values[(int32)EAIObjective::Survival] = Random.GetFraction() < 0.3f ? 1.0f : 0.0f;
+		Values[(int32)EAIObjective::Exploration] = Random.GetFraction();
+		Values[(int32)EAIObjective::Energy] = Random.GetFraction();
+		Values[(int32)EAIObjective::Diversity] = 1.0f - (Random.RandHelper(50) + 1) / 50.0f;
+		Values[(int32)EAIObjective::Novelty] = Random.GetFraction();
+
+		Members[i] = i;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIParetoFrontsTest, "AIEntity.Pareto.FrontsMatchDominationPeeling",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIParetoFrontsTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Num = 500;
+
+	TArray<float> Objectives;
+	TArray<int32> Members;
+	FillObjectives(Objectives, Members, Num, 1);
+
+	FAIParetoRanking Pareto;
+	Pareto.Rank(Objectives, AIObjectiveNum, Members);
+
+	auto Dominates = [&](int32 A, int32 B)
+	{
+		bool bBetter = false;
+
+		for (int32 m = 0; m < AIObjectiveNum; m++)
+		{
+			const float ValueA = Objectives[A * AIObjectiveNum + m], ValueB = Objectives[B * AIObjectiveNum + m];
+
+			if (ValueA < ValueB) return false;
+
+			bBetter |= ValueA > ValueB;
+		}
+
+		return bBetter;
+	};
+
+	// Fronts peeled off one at a time, the O(M*N^2) ranking the sort replaces
+	TArray<int32> Ranks;
+	Ranks.Init(INDEX_NONE, Num);
+
+	for (int32 Front = 0, Ranked = 0; Ranked < Num; Front++)
+	{
+		TArray<int32> Peeled;
+
+		for (int32 i = 0; i < Num; i++)
+		{
+			if (Ranks[i] != INDEX_NONE) continue;
+
+			bool bDominated = false;
+
+			for (int32 j = 0; j < Num && !bDominated; j++)
+				bDominated = Ranks[j] == INDEX_NONE && Dominates(j, i);
+
+			if (!bDominated) Peeled.Add(i);
+		}
+
+		for (const int32 i : Peeled) Ranks[i] = Front;
+
+		Ranked += Peeled.Num();
+	}
+
+	int32 Mismatches = 0;
+
+	for (int32 i = 0; i < Num; i++) Mismatches += Pareto.GetRank(i) != Ranks[i];
+
+	TestEqual(TEXT("Ranks differing from peeling"), Mismatches, 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIParetoRankBenchmark, "AIEntity.Perf.ParetoRank",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FAIParetoRankBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 Runs = 10;
+
+	for (const int32 Num : {1000, 10000, 50000})
+	{
+		TArray<float> Objectives;
+		TArray<int32> Members;
+		FillObjectives(Objectives, Members, Num, Num);
+
+		FAIParetoRanking Pareto;
+
+		// The first ranking sizes the fronts and crowding arrays
+		Pareto.Rank(Objectives, AIObjectiveNum, Members);
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Run = 0; Run < Runs; Run++) Pareto.Rank(Objectives, AIObjectiveNum, Members);
+
+		AddInfo(FString::Printf(TEXT("%d entities: %d fronts, ranking took %.3f ms"), Num, Pareto.GetFrontNum(),
+		                        (FPlatformTime::Seconds() - StartTime) * 1000.0 / Runs));
+	}
+
+	return true;
+}
+
+#endif
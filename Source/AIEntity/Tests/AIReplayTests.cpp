@@ -0,0 +1,65 @@
+#include "AITestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIPopulationSubsystem.h"
+#include "../AI-Setup/AIReplay.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIReplaySeekTest, "AIEntity.Replay.SeekRebuildsTheRecordedRun",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIReplaySeekTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 EntityNum = 9, Seed = 11, Frames = 30;
+	const FString Directory = FAIReplayIndex::RunDirectory(Seed);
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	// Generation 1 is only reached through the journal of the keyframe at generation 0
+	FAIScopedConsoleVariable Replay(TEXT("AIEntity.Replay"), 1);
+	FAIScopedConsoleVariable Interval(TEXT("AIEntity.Replay.KeyframeInterval"), 100);
+
+	uint64 First = 0, Started = 0, Continued = 0;
+
+	{
+		FAITestWorld TestWorld(EntityNum, Seed);
+		TestWorld.Step(1);
+		First = TestWorld.Fingerprint();
+
+		while (TestWorld.GetPopulation().GetGeneration() == 0) TestWorld.Step(1);
+
+		Started = TestWorld.Fingerprint();
+
+		TestWorld.Step(Frames);
+		Continued = TestWorld.Fingerprint();
+	}
+
+	// The seeking world only watches, it never records over the keyframes
+	Replay.Set(0);
+
+	{
+		FAITestWorld TestWorld(EntityNum, Seed);
+		TestWorld.Step(1);
+
+		UAIPopulationSubsystem& Population = TestWorld.GetPopulation();
+
+		if (TestTrue(TEXT("Generation 1 sought"), Population.Seek(1, 0, Seed)))
+		{
+			TestEqual(TEXT("Generation 1 rebuilt"), TestWorld.Fingerprint(), Started);
+
+			TestWorld.Step(Frames);
+			TestEqual(TEXT("Generation 1 continued"), TestWorld.Fingerprint(), Continued);
+		}
+
+		if (TestTrue(TEXT("Generation 0 sought"), Population.Seek(0, 0, Seed)))
+			TestEqual(TEXT("Generation 0 rebuilt"), TestWorld.Fingerprint(), First);
+	}
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "AITestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIEntityCharacter.h"
+#include "Misc/AutomationTest.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAISensorProbeStorageTest, "AIEntity.Sensors.ProbeHitsKeepTheirStorage",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAISensorProbeStorageTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Frames = 120;
+
+	for (const bool bLatencyTolerant : {false, true})
+	{
+		FAITestWorld TestWorld(32, 7, [bLatencyTolerant](AAIEntityCharacter& Entity)
+		{
+			Entity.bLatencyTolerantSensors = bLatencyTolerant;
+		});
+
+		// Hit lists grow to the most hits of any probe while warming up
+		TestWorld.Step(30);
+
+		const TArray<AAIEntityCharacter*>& Entities = TestWorld.GetEntities();
+		constexpr int32 RayNum = (int32)EAIProbeRay::Count;
+
+		TArray<const FHitResult*> Storage;
+		TArray<int32> Capacity;
+
+		for (const AAIEntityCharacter* Entity : Entities)
+		{
+			for (uint8 Ray = 0; Ray < RayNum; Ray++)
+			{
+				const TArray<FHitResult>& Hits = Entity->GetSensorProbes().GetResult((EAIProbeRay)Ray).Hits;
+				Storage.Add(Hits.GetData());
+				Capacity.Add(Hits.Max());
+			}
+		}
+
+		int32 Allocations = 0, AvoidableAllocations = 0, Traced = 0;
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < Frames; Frame++)
+		{
+			TestWorld.Step(1);
+
+			for (int32 i = 0; i < Entities.Num(); i++)
+			{
+				for (uint8 Ray = 0; Ray < RayNum; Ray++)
+				{
+					const FAIProbeResult& Result = Entities[i]->GetSensorProbes().GetResult((EAIProbeRay)Ray);
+					const int32 Slot = i * RayNum + Ray;
+
+					Traced += Result.Epoch != MAX_uint32;
+
+					if (Result.Hits.GetData() == Storage[Slot]) continue;
+
+					// Only a probe with more hits than ever before may need a larger list
+					Allocations++;
+					AvoidableAllocations += Result.Hits.Num() <= Capacity[Slot];
+
+					Storage[Slot] = Result.Hits.GetData();
+					Capacity[Slot] = Result.Hits.Max();
+				}
+			}
+		}
+
+		AddInfo(FString::Printf(TEXT("%s probes: %d hit list allocations in %d frames, %.3f ms per frame"),
+		                        bLatencyTolerant ? TEXT("Async") : TEXT("Blocking"), Allocations, Frames,
+		                        (FPlatformTime::Seconds() - StartTime) * 1000.0 / Frames));
+
+		TestTrue(TEXT("Probes were traced"), Traced > 0);
+		TestEqual(TEXT("Hit lists reallocated without growing"), AvoidableAllocations, 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIPopulationSensorBarrierTest, "AIEntity.Sensors.PopulationStopsAtBarriers",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIPopulationSensorBarrierTest::RunTest(const FString& Parameters)
+{
+	// Three entities in a row facing east, a wall between the second and the third
+	FAITestWorld TestWorld(3, 7);
+	TestWorld.AddBox(FVector(750.0, 300.0, 200.0), FVector(10.0, 300.0, 200.0));
+
+	const TArray<AAIEntityCharacter*>& Entities = TestWorld.GetEntities();
+
+	auto CountAhead = [](AAIEntityCharacter* Entity)
+	{
+		return FMath::RoundToInt32(Entity->SampleSensor(EAISensory::POPULATION_FWD, 0) * Entity->PopulationRef.Num());
+	};
+
+	TestEqual(TEXT("Entities seen ahead of the first"), CountAhead(Entities[0]), 1);
+	TestEqual(TEXT("Entities seen ahead of the second"), CountAhead(Entities[1]), 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "AITestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIEntityCharacter.h"
+#include "../AI-Setup/AIPopulationSubsystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAISnapshotDeterminismTest, "AIEntity.Snapshot.LoadedRunTakesTheSameSteps",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAISnapshotDeterminismTest::RunTest(const FString& Parameters)
+{
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("AIEntity") / TEXT("Tests") / TEXT("Determinism.snapshot");
+	constexpr int32 EntityNum = 9, Seed = 7, Frames = 90;
+
+	// Saved mid generation, while cached sensor values and async probe hits are still being read
+	for (const bool bLatencyTolerant : {false, true})
+	{
+		auto Configure = [bLatencyTolerant](AAIEntityCharacter& Entity)
+		{
+			Entity.bLatencyTolerantSensors = bLatencyTolerant;
+		};
+
+		uint64 Saved = 0, Continued = 0;
+
+		{
+			FAITestWorld TestWorld(EntityNum, Seed, Configure);
+			TestWorld.Step(60);
+
+			Saved = TestWorld.Fingerprint();
+			TestWorld.GetPopulation().SaveSnapshot(Path);
+
+			TestWorld.Step(Frames);
+			Continued = TestWorld.Fingerprint();
+		}
+
+		{
+			// A run already under way is replaced by the snapshot
+			FAITestWorld TestWorld(EntityNum, Seed, Configure);
+			TestWorld.Step(10);
+
+			if (!TestTrue(TEXT("Snapshot loaded"), TestWorld.GetPopulation().LoadSnapshot(Path))) break;
+
+			const TCHAR* Mode = bLatencyTolerant ? TEXT("latency tolerant") : TEXT("blocking");
+
+			TestEqual(FString::Printf(TEXT("Loaded state, %s"), Mode), TestWorld.Fingerprint(), Saved);
+
+			TestWorld.Step(Frames);
+			TestEqual(FString::Printf(TEXT("Continued state, %s"), Mode), TestWorld.Fingerprint(), Continued);
+		}
+	}
+
+	IFileManager::Get().Delete(*Path, false, true, true);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIGenomeKernels.h"
+#include "Misc/AutomationTest.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAISignatureLikenessTest, "AIEntity.Species.LikenessEstimatesSharedGenes",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAISignatureLikenessTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 GeneNum = 64, SharedNum = 32, Trials = 400;
+	FRandomStream Random(3);
+
+	TArray<FAIGene> A, B;
+	A.SetNumUninitialized(GeneNum);
+	B.SetNumUninitialized(GeneNum);
+
+	// Half of the genes are shared, the gene sets overlap by a third
+	const float Jaccard = (float)SharedNum / (2 * GeneNum - SharedNum);
+	double Sum = 0.0;
+
+	for (int32 Trial = 0; Trial < Trials; Trial++)
+	{
+		FAIGenomeKernels::RandomGenes(A.GetData(), GeneNum, Random);
+		FAIGenomeKernels::RandomGenes(B.GetData(), GeneNum, Random);
+		FMemory::Memcpy(B.GetData(), A.GetData(), SharedNum * sizeof(FAIGene));
+
+		FAIGenomeSignature SignatureA, SignatureB;
+		FAIGenomeKernels::Sign(A, SignatureA);
+		FAIGenomeKernels::Sign(B, SignatureB);
+
+		Sum += SignatureA.Likeness(SignatureB);
+	}
+
+	// Correlated hash functions agree or disagree together and skew the mean away from the overlap
+	TestNearlyEqual(TEXT("Mean likeness"), (float)(Sum / Trials), Jaccard, 0.03f);
+
+	FAIGenomeSignature Signature, Same;
+	FAIGenomeKernels::Sign(A, Signature);
+	FAIGenomeKernels::Sign(A, Same);
+
+	TestEqual(TEXT("Same genome"), Signature.Likeness(Same), 1.0f);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include "AITestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIEntityCharacter.h"
+#include "../AI-Setup/AIPopulationSubsystem.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Hash/CityHash.h"
+#include "HAL/IConsoleManager.h"
+
+FAITestWorld::FAITestWorld(int32 EntityNum, int32 Seed, TFunction<void(AAIEntityCharacter&)> Configure)
+{
+	// The population reads its seed when the first entity joins
+	IConsoleVariable* SeedVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("AIEntity.Seed"));
+	SavedSeed = SeedVariable->GetInt();
+	SeedVariable->Set(Seed, ECVF_SetByCode);
+
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("AITestWorld"));
+
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	// Floor and walls around the known space of the entities
+	AddBox(FVector(1500.0, 1750.0, -50.0), FVector(1600.0, 1850.0, 50.0));
+	AddBox(FVector(1500.0, 0.0, 200.0), FVector(1600.0, 50.0, 200.0));
+	AddBox(FVector(1500.0, 3500.0, 200.0), FVector(1600.0, 50.0, 200.0));
+	AddBox(FVector(0.0, 1750.0, 200.0), FVector(50.0, 1850.0, 200.0));
+	AddBox(FVector(3000.0, 1750.0, 200.0), FVector(50.0, 1850.0, 200.0));
+
+	for (int32 i = 0; i < EntityNum; i++)
+	{
+		const FTransform Transform(FVector(300.0 + i % 9 * 300.0, 300.0 + i / 9 % 10 * 300.0, 100.0));
+
+		AAIEntityCharacter* Entity = World->SpawnActorDeferred<AAIEntityCharacter>(
+			AAIEntityCharacter::StaticClass(),
+			Transform,
+			nullptr,
+			nullptr,
+			ESpawnActorCollisionHandlingMethod::AlwaysSpawn
+		);
+
+		if (Configure) Configure(*Entity);
+
+		Entity->FinishSpawning(Transform);
+		Entities.Add(Entity);
+	}
+}
+
+FAITestWorld::~FAITestWorld()
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	IConsoleManager::Get().FindConsoleVariable(TEXT("AIEntity.Seed"))->Set(SavedSeed, ECVF_SetByCode);
+}
+
+void FAITestWorld::Step(int32 Frames)
+{
+	for (int32 i = 0; i < Frames; i++)
+	{
+		// Per frame caches of the population are keyed on the frame counter
+		GFrameCounter++;
+		World->Tick(LEVELTICK_All, StepSeconds);
+	}
+}
+
+FAIScopedConsoleVariable::FAIScopedConsoleVariable(const TCHAR* Name, int32 Value)
+	: Variable(IConsoleManager::Get().FindConsoleVariable(Name))
+{
+	check(Variable);
+
+	SavedValue = Variable->GetString();
+	Set(Value);
+}
+
+FAIScopedConsoleVariable::~FAIScopedConsoleVariable()
+{
+	Variable->Set(*SavedValue, ECVF_SetByCode);
+}
+
+void FAIScopedConsoleVariable::Set(int32 Value)
+{
+	Variable->Set(Value, ECVF_SetByCode);
+}
+
+void FAITestWorld::AddBox(const FVector& Center, const FVector& Extent)
+{
+	AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Center, FRotator::ZeroRotator);
+	UStaticMeshComponent* Mesh = Box->GetStaticMeshComponent();
+
+	// Static components can not change their mesh once the world plays
+	Mesh->SetMobility(EComponentMobility::Movable);
+	Mesh->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+	Mesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+
+	// The cube is 100 units wide
+	Box->SetActorScale3D(Extent / 50.0);
+}
+
+uint64 FAITestWorld::Fingerprint() const
+{
+	const UAIPopulationSubsystem& Population = GetPopulation();
+	const FAITraitStore& Traits = Population.GetTraits();
+
+	const FAIGenomeArena::FReadScope ReadScope(Population.GetGenomeArena());
+	const uint32 Clock[2] = {Population.GetGeneration(), Population.GetCurrentStep()};
+	uint64 Hash = CityHash64(reinterpret_cast<const char*>(Clock), sizeof(Clock));
+
+	auto Mix = [&Hash](const void* Data, int32 Size)
+	{
+		Hash = CityHash64WithSeed(static_cast<const char*>(Data), Size, Hash);
+	};
+
+	for (const AAIEntityCharacter* Entity : Entities)
+	{
+		const int32 Index = Entity->GetPopulationIndex();
+		const FVector Location = Entity->GetActorLocation();
+		const FRotator Rotation = Entity->GetActorRotation();
+		const FVector Velocity = Entity->GetVelocity();
+		const FRotator ControlRotation = Entity->GetControlRotation();
+		const bool bAlive = Entity->IsAlive();
+		const unsigned Age = Entity->GetAge();
+		const float State[3] = {Traits.Health[Index], Traits.Stamina[Index], Traits.Speed[Index]};
+		const TArrayView<const FAIGene> Genome = Entity->GetGenome();
+		const int32 TouchCount = Entity->GetTouchCount();
+		FAIBehavior Behavior;
+		Entity->GetBehavior(Entity->GetActorLocation(), Behavior);
+
+		Mix(&Location, sizeof(FVector));
+		Mix(&Rotation, sizeof(FRotator));
+		Mix(&Velocity, sizeof(FVector));
+		Mix(&ControlRotation, sizeof(FRotator));
+		Mix(&bAlive, sizeof(bool));
+		Mix(&Age, sizeof(unsigned));
+		Mix(State, sizeof(State));
+		Mix(Genome.GetData(), Genome.Num() * sizeof(FAIGene));
+		Mix(&TouchCount, sizeof(int32));
+		Mix(Behavior.Values, sizeof(Behavior.Values));
+	}
+
+	return Hash;
+}
+
+UAIPopulationSubsystem& FAITestWorld::GetPopulation() const
+{
+	return *World->GetSubsystem<UAIPopulationSubsystem>();
+}
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class AAIEntityCharacter;
+class UAIPopulationSubsystem;
+struct IConsoleVariable;
+
+/**
+ * Game world with a walled floor and a population of entities for automation tests. Every frame is
+ * ticked on the same time step, so two worlds of the same seed take exactly the same steps.
+ */
+class FAITestWorld
+{
+public:
+	static constexpr float StepSeconds = 1.0f / 30.0f;
+
+	/**
+	 * Create the world and spawn the population on a grid inside the walls
+	 *
+	 * @param EntityNum Entities to spawn
+	 * @param Seed Seed of the population
+	 * @param Configure Called on every entity before it starts playing
+	 */
+	FAITestWorld(int32 EntityNum, int32 Seed, TFunction<void(AAIEntityCharacter&)> Configure = nullptr);
+
+	~FAITestWorld();
+
+	/** Tick the world a number of frames, the population takes one step per frame */
+	void Step(int32 Frames);
+
+	/** Block static geometry, walls count as barriers for the sensors */
+	void AddBox(const FVector& Center, const FVector& Extent);
+
+	/** Hash of everything the next steps depend on: transforms, velocities, genomes, traits, ages and behaviors */
+	uint64 Fingerprint() const;
+
+	UWorld* GetWorld() const { return World; }
+
+	UAIPopulationSubsystem& GetPopulation() const;
+
+	const TArray<AAIEntityCharacter*>& GetEntities() const { return Entities; }
+
+private:
+	UWorld* World = nullptr;
+
+	TArray<AAIEntityCharacter*> Entities;
+
+	/** Seed the console variable had before the test */
+	int32 SavedSeed = 0;
+};
+
+/** Sets a console variable for the lifetime of a test and restores it afterwards */
+class FAIScopedConsoleVariable
+{
+public:
+	FAIScopedConsoleVariable(const TCHAR* Name, int32 Value);
+
+	~FAIScopedConsoleVariable();
+
+	UE_NONCOPYABLE(FAIScopedConsoleVariable);
+
+	void Set(int32 Value);
+
+private:
+	IConsoleVariable* Variable = nullptr;
+
+	FString SavedValue;
+};
+
+#endif
@@ -0,0 +1,123 @@
+#include "AITestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../AI-Setup/AIEntityCharacter.h"
+#include "../AI-Setup/AIInteraction.h"
+#include "../AI-Setup/AIPopulationSubsystem.h"
+#include "../AI-Setup/AITraits.h"
+#include "Misc/AutomationTest.h"
+
+/** One step of a single entity, the scalar form of FAITraitStore::Step */
+static void StepScalar(const FAITraitRates& Rates, float& Health, float& Stamina, float& Speed, float Moved,
+                       float Sprint, float Heal, float Damage)
+{
+	Stamina = FMath::Clamp(Stamina + Rates.Recovery - Moved * Rates.MoveCost - Sprint * Rates.SprintCost -
+	                       Heal * Rates.HealCost, 0.0f, 1.0f);
+	Health = FMath::Clamp(Health - Damage + (Stamina > 0.0f ? Heal * Rates.HealRate : 0.0f), 0.0f, 1.0f);
+	Speed = (Stamina * (1.0f - Rates.ExhaustedSpeed) + Rates.ExhaustedSpeed) * (Sprint * Rates.SprintBoost + 1.0f);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAITraitStepBenchmark, "AIEntity.Perf.TraitsStep",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FAITraitStepBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 Steps = 200;
+
+	for (const int32 Num : {1000, 10000, 100000})
+	{
+		FAITraitStore Traits;
+		for (int32 i = 0; i < Num; i++) Traits.Add();
+
+		TArray<float> Health, Stamina, Speed, Moved, Sprint, Heal, Damage;
+		FRandomStream Random(Num);
+
+		for (TArray<float>* Column : {&Moved, &Sprint, &Heal, &Damage}) Column->SetNumUninitialized(Num);
+
+		for (int32 i = 0; i < Num; i++)
+		{
+			Moved[i] = Random.GetFraction() < 0.7f ? 1.0f : 0.0f;
+			Sprint[i] = Random.GetFraction();
+			Heal[i] = Random.GetFraction();
+			Damage[i] = Random.GetFraction() < 0.05f ? 0.1f : 0.0f;
+		}
+
+		Health.Init(1.0f, Num);
+		Stamina.Init(1.0f, Num);
+		Speed.Init(1.0f, Num);
+
+		double VectorSeconds = 0.0, ScalarSeconds = 0.0;
+		float Error = 0.0f;
+
+		for (int32 Step = 0; Step < Steps; Step++)
+		{
+			FMemory::Memcpy(Traits.Moved.GetData(), Moved.GetData(), Num * sizeof(float));
+			FMemory::Memcpy(Traits.Sprint.GetData(), Sprint.GetData(), Num * sizeof(float));
+			FMemory::Memcpy(Traits.Heal.GetData(), Heal.GetData(), Num * sizeof(float));
+			FMemory::Memcpy(Traits.Damage.GetData(), Damage.GetData(), Num * sizeof(float));
+
+			double StartTime = FPlatformTime::Seconds();
+			Traits.Step();
+			VectorSeconds += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+
+			for (int32 i = 0; i < Num; i++)
+				StepScalar(Traits.Rates, Health[i], Stamina[i], Speed[i], Moved[i], Sprint[i], Heal[i], Damage[i]);
+
+			ScalarSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		for (int32 i = 0; i < Num; i++)
+		{
+			Error = FMath::Max(Error, FMath::Abs(Traits.Health[i] - Health[i]));
+			Error = FMath::Max(Error, FMath::Abs(Traits.Stamina[i] - Stamina[i]));
+			Error = FMath::Max(Error, FMath::Abs(Traits.Speed[i] - Speed[i]));
+		}
+
+		AddInfo(FString::Printf(TEXT("%d entities: vectorized step %.2f ns, scalar step %.2f ns per entity"), Num,
+		                        VectorSeconds * 1e9 / ((double)Steps * Num),
+		                        ScalarSeconds * 1e9 / ((double)Steps * Num)));
+
+		// Fused multiply-adds may round differently from the scalar form
+		TestTrue(TEXT("Vectorized step matches the scalar step"), Error < 1e-4f);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIInteractionCommitTest, "AIEntity.Traits.InteractionsResolveBySlot",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIInteractionCommitTest::RunTest(const FString& Parameters)
+{
+	FAITestWorld TestWorld(4, 7);
+	const TArray<TObjectPtr<AAIEntityCharacter>>& Entities = TestWorld.GetPopulation().GetEntities();
+
+	if (!TestEqual(TEXT("Population"), Entities.Num(), 4)) return false;
+
+	FAITraitStore Traits;
+	for (int32 i = 0; i < Entities.Num(); i++) Traits.Add();
+
+	// Never dereferenced, only compared against the population
+	AAIEntityCharacter* Gone = reinterpret_cast<AAIEntityCharacter*>(alignof(AAIEntityCharacter));
+
+	FAIInteractionQueue Queue;
+	Queue.Emit({Entities[2], Entities[0], 2, 0, EAIInteraction::Kill, 0.25f});
+	Queue.Emit({Entities[1], Entities[0], 1, 0, EAIInteraction::Kill, 0.5f});
+	Queue.Emit({Gone, Entities[3], 5, 3, EAIInteraction::Kill, 1.0f});
+	Queue.Emit({Entities[1], Entities[3], 0, 3, EAIInteraction::Kill, 1.0f});
+	Queue.Commit(Entities, Traits);
+
+	TestEqual(TEXT("The first killer by slot deals the damage"), Traits.Damage[0], 0.5f);
+	TestEqual(TEXT("Intents of entities that left or moved are dropped"), Traits.Damage[3], 0.0f);
+
+	// Nothing stays queued after a commit
+	Queue.Commit(Entities, Traits);
+	TestEqual(TEXT("Damage is dealt once"), Traits.Damage[0], 0.5f);
+
+	return true;
+}
+
+#endif